@@ -0,0 +1,20 @@
+# path.jerryio exports in static/ are compiled by tools/pathc.py into packed
+# waypoint arrays (see include/path.hpp) and linked in place of the text,
+# with speeds planned from the limits in include/drive.hpp.
+# Other files in static/ are still linked raw by hot-cold-asset.mk.
+PATH_FILES=$(wildcard static/*.txt)
+
+PATH_OBJ=$(patsubst static/%.txt,$(BINDIR)/paths/static/%.path.o,$(PATH_FILES))
+
+ASSET_OBJ=$(addprefix $(BINDIR)/, $(addsuffix .o, $(filter-out $(PATH_FILES),$(ASSET_FILES)))) $(PATH_OBJ)
+
+$(BINDIR)/paths/static/%.path: static/%.txt tools/pathc.py include/drive.hpp
+	$(VV)mkdir -p $(dir $@)
+	@echo "PATH $@"
+	$(VV)python3 tools/pathc.py $< $@
+
+# run from bin/paths so the symbols are _binary_static_<name>_path_start/_size;
+# the waypoints are read in place as floats, so keep them 4 byte aligned
+$(BINDIR)/paths/static/%.path.o: $(BINDIR)/paths/static/%.path
+	@echo "ASSET $@"
+	$(VV)cd $(BINDIR)/paths && $(OBJCOPY) -I binary -O elf32-littlearm -B arm --set-section-alignment .data=4 static/$*.path $(abspath $@)
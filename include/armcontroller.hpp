@@ -0,0 +1,98 @@
+// armcontroller.hpp
+#include "api.h"
+#include "motionprofile.hpp"
+
+#ifndef ARMCONTROLLER_HPP
+#define ARMCONTROLLER_HPP
+
+namespace robot {
+    // Voltage feedforward and feedback of an arm, in mV and centidegrees of its rotation sensor
+    struct ArmGains {
+        ArmGains(float kG, float kS, float kV, float kA, float kP, float kD)
+            : kG(kG),
+              kS(kS),
+              kV(kV),
+              kA(kA),
+              kP(kP),
+              kD(kD) {}
+
+        float kG; // mV holding the arm up when it is horizontal
+        float kS; // mV to overcome friction
+        float kV; // mV per centidegree/s
+        float kA; // mV per centidegree/s^2
+        float kP; // mV per centidegree of position error
+        float kD; // mV per centidegree/s of velocity error
+    };
+
+    // How an arm moves and when it counts as there
+    struct ArmSettings {
+        ArmSettings(float maxVelocity, float maxAcceleration, float horizontal, float tolerance,
+                    float velocityTolerance, uint32_t settleTime, uint32_t timeout)
+            : maxVelocity(maxVelocity),
+              maxAcceleration(maxAcceleration),
+              horizontal(horizontal),
+              tolerance(tolerance),
+              velocityTolerance(velocityTolerance),
+              settleTime(settleTime),
+              timeout(timeout) {}
+
+        float maxVelocity; // centidegrees/s
+        float maxAcceleration; // centidegrees/s^2
+        float horizontal; // rotation sensor reading with the arm level, where gravity pulls hardest
+        float tolerance; // centidegrees
+        float velocityTolerance; // centidegrees/s
+        uint32_t settleTime; // ms within both tolerances to be settled
+        uint32_t timeout; // ms after the profile ends to give up settling
+    };
+
+    /**
+     * Moves an arm along a trapezoidal profile with gravity, velocity and acceleration feedforward.
+     *
+     * moveTo() plans the profile from where the arm is, carrying on from its velocity when it is already
+     * moving that way. Each update() drives the motor's voltage with kG * cos(angle from horizontal), kS,
+     * kV and kA on the profile's velocity and acceleration, and PD on its position and velocity errors.
+     * The move is done once the arm stays within the tolerances for settleTime, or timeout after the
+     * profile ended; the motor is then left holding at zero velocity. The rest position 0 is a hard stop:
+     * a move there is done as soon as the arm is within tolerance of it, and the motor coasts.
+     */
+    class ArmController {
+    public:
+        ArmController(pros::Motor* motor, pros::Rotation* sensor, ArmSettings settings, ArmGains gains);
+
+        /**
+         * @brief Start moving to a position
+         *
+         * @param target centidegrees
+         * @param speed fraction of the velocity limit, 0 - 1
+         */
+        void moveTo(float target, float speed = 1);
+
+        // Drive the motor along the profile. Call every tick while moving
+        void update();
+
+        // Stop moving, e.g. when the driver takes the arm over; leaves the motor as it is
+        void stop();
+
+        bool isMoving();
+        bool timedOut(); // the last move gave up instead of settling
+        float getTarget();
+    private:
+        pros::Motor* motor;
+        pros::Rotation* sensor;
+        ArmSettings settings;
+        ArmGains gains;
+        SCurve profile;
+        float start = 0;
+        float target = 0;
+        float direction = 1;
+        bool moving = false;
+        bool gaveUp = false;
+        uint32_t startTime = 0;
+        uint32_t settledSince = 0; // 0 when outside the tolerances
+        float lastPosition = 0;
+        uint32_t lastTime = 0;
+        float velocity = 0; // centidegrees/s, filtered
+    };
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef _AUTO_H_
 #define _AUTO_H_
 
+#include "colorsort.hpp"
+#include "coroutine.hpp"
+
 // Autonomous routine declarations
 enum class AutonomousMode {
     SKILLS,
@@ -9,17 +12,32 @@ enum class AutonomousMode {
     BLUE_RING,
     BLUE_STAKE,      
     TEST,
-    SCREW
+    SCREW,
+    CHARACTERIZE
 };
 
 extern AutonomousMode current_auto;
 
-void skills_auto();
-void red_ring_auto();
-void red_stake_auto();
-void blue_ring_auto();
-void blue_stake_auto();
-void test_auto();
+// The other alliance's ring color, for the color sort to throw out (NONE with constants::COLOR_SORT off)
+robot::RingColor rejected_color();
+
+// Whether the routine sets its poses in a mirrored copy of the field (it drives the other side's paths),
+// so sensors that read the real field, the GPS, must not correct them
+bool mirrored_frame(AutonomousMode mode);
+
+// Give the odometry back the GPS a mirrored routine took off it. autonomous() does this when the routine
+// returns; opcontrol() does it too, for a routine cut off at the end of the autonomous period
+void restore_gps();
+
+// Routines run as coroutines on the autonomous runtime (coroutine.hpp)
+robot::co::Task skills_auto();
+robot::co::Task red_ring_auto();
+robot::co::Task red_stake_auto();
+robot::co::Task blue_ring_auto();
+robot::co::Task blue_stake_auto();
+robot::co::Task test_auto();
+// Blocks; runs on its own without the runtime
+void characterize_auto();
 
 
 #endif // _AUTO_H_ 
\ No newline at end of file
@@ -0,0 +1,24 @@
+// bench.hpp
+//
+// Timing hooks for the autonomous benchmark in sim/. On the robot they
+// compile to nothing.
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#ifdef AUTOSIM
+#include "sim/report.hpp"
+// charge the time spent in the enclosing block to the given category
+#define BENCH_CALL(name) sim::Scope benchScope(name)
+// record the enclosing block as a motion in the per-motion table; it settled unless told otherwise
+#define BENCH_MOTION(name) sim::MotionScope benchMotion(name)
+// the motion got within its large error range
+#define BENCH_MOTION_NEAR() benchMotion.near()
+#define BENCH_MOTION_EXIT(reason) benchMotion.exit(reason)
+#else
+#define BENCH_CALL(name)
+#define BENCH_MOTION(name)
+#define BENCH_MOTION_NEAR()
+#define BENCH_MOTION_EXIT(reason)
+#endif
+
+#endif
@@ -0,0 +1,22 @@
+// characterize.hpp
+#include "api.h"
+
+#ifndef CHARACTERIZE_HPP
+#define CHARACTERIZE_HPP
+
+namespace robot {
+    /**
+     * @brief Drive the voltage tests that tools/characterize.py fits the drive feedforward to
+     *
+     * Runs a quasistatic voltage ramp and a dynamic voltage step forwards and backwards on both sides of the
+     * drive, resting in between, and writes one line per 10 ms to <directory>/characterize.csv: the test,
+     * the time into it (ms), the voltage (V), the forward velocity (in/s) and the acceleration (in/s^2).
+     * The robot needs about 80 inches of clear floor ahead of it and comes back to about where it started.
+     * Takes about 14 seconds.
+     *
+     * @return false if the file could not be written, e.g. without an SD card
+     */
+    bool characterizeDrive(const char* directory);
+}
+
+#endif
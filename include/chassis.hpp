@@ -0,0 +1,287 @@
+// chassis.hpp
+#include "lemlib/api.hpp"
+#include "lemlib/timer.hpp"
+#include "coroutine.hpp"
+#include "devices.hpp"
+#include "motionprofile.hpp"
+#include "odometry.hpp"
+#include "path.hpp"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#ifndef CHASSIS_HPP
+#define CHASSIS_HPP
+
+namespace robot {
+    // Limits and gains of the profiled motions, outputs in motor units (-127 to 127)
+    struct DriveProfile {
+        DriveProfile(float maxVelocity, float maxAcceleration, float maxJerk, float kS, float kV, float kA,
+                     float kP, float kD)
+            : limits {maxVelocity, maxAcceleration, maxJerk},
+              kS(kS),
+              kV(kV),
+              kA(kA),
+              kP(kP),
+              kD(kD) {}
+
+        ProfileLimits limits;
+        float kS; // output to get moving
+        float kV; // output per in/s
+        float kA; // output per in/s^2
+        float kP; // output per inch behind the profile
+        float kD; // output per in/s slower than the profile
+    };
+
+    struct ProfiledMoveParams {
+        bool forwards = true;
+        float maxVelocity = 0; // in/s, 0 for the drive profile's limit
+        float maxAcceleration = 0; // in/s^2, 0 for the drive profile's limit
+        float endVelocity = 0; // in/s to still be moving at on arrival, hands over to the next motion
+        float earlyExitRange = 0; // in, exit this far from the target
+    };
+
+    // Path tracking engines of Chassis::follow
+    enum class Tracker {
+        PURE_PURSUIT, // steer at a point a lookahead ahead, at the waypoint speeds
+        RAMSETE, // track the path's planned timing with RAMSETE and wheel velocity feedforward
+    };
+
+    struct FollowParams {
+        bool forwards = true;
+        Tracker tracker = Tracker::PURE_PURSUIT;
+        float lookahead = 10; // in (PURE_PURSUIT)
+        float b = 2; // RAMSETE convergence gain, rad^2/m^2 as usually quoted, > 0
+        float zeta = 0.7; // RAMSETE damping, 0 to 1
+    };
+
+    // One motion of Chassis::chain
+    struct ChainStep {
+        enum class Kind { POINT, HEADING, SWING, PATH } kind;
+        float x = 0; // point to drive through (POINT)
+        float y = 0;
+        float theta = 0; // heading to turn to, degrees (HEADING, SWING)
+        bool forwards = true;
+        float maxVelocity = 0; // in/s on the way to the point or along the path, 0 for the chain's limit
+        lemlib::DriveSide lockedSide = lemlib::DriveSide::LEFT; // SWING
+        const asset* path = nullptr; // compiled path to drive along (PATH)
+
+        static ChainStep point(float x, float y, bool forwards = true, float maxVelocity = 0) {
+            return {Kind::POINT, x, y, 0, forwards, maxVelocity};
+        }
+
+        static ChainStep heading(float theta) { return {Kind::HEADING, 0, 0, theta}; }
+
+        static ChainStep swing(float theta, lemlib::DriveSide lockedSide) {
+            return {Kind::SWING, 0, 0, theta, true, 0, lockedSide};
+        }
+
+        static ChainStep follow(const asset& path, bool forwards = true, float maxVelocity = 0) {
+            return {Kind::PATH, 0, 0, 0, forwards, maxVelocity, lemlib::DriveSide::LEFT, &path};
+        }
+    };
+
+    struct ChainParams {
+        float maxVelocity = 0; // in/s, 0 for the drive profile's limit
+        float maxAcceleration = 0; // in/s^2, 0 for the drive profile's limit
+        float lateralAcceleration = 0; // in/s^2 allowed through corners, 0 for the acceleration limit
+        float blend = 8; // in, corners are rounded off starting this far before the point
+        float lookahead = 8; // in, pure pursuit lookahead
+        float endVelocity = 0; // in/s to still be moving at after the last step
+    };
+
+    // lemlib::Chassis with the motions this robot does differently
+    class Chassis : public lemlib::Chassis {
+    public:
+        using lemlib::Chassis::Chassis;
+
+        // The left side of the drive should be a CachedMotorGroup: the triggers of LemLib's motions are checked
+        // from the commands their loops send it
+        Chassis(lemlib::Drivetrain drivetrain, lemlib::ControllerSettings linearSettings,
+                lemlib::ControllerSettings angularSettings, lemlib::OdomSensors sensors, DriveProfile profile,
+                lemlib::DriveCurve* throttleCurve = &lemlib::defaultDriveCurve,
+                lemlib::DriveCurve* steerCurve = &lemlib::defaultDriveCurve);
+
+        /**
+         * @brief Follow a path with pure pursuit
+         *
+         * Takes a compiled path (PATH_ASSET in path.hpp) and reads its waypoints in place. Raw
+         * path.jerryio text assets are handed to lemlib::Chassis::follow.
+         */
+        void follow(const asset& path, float lookahead, int timeout, bool forwards = true, bool async = true);
+
+        /**
+         * @brief Follow a compiled path with the chosen tracker
+         *
+         * Tracker::RAMSETE drives the path on the timing planned by tools/pathc.py: it tracks where the
+         * profile puts the robot at each moment, with a RAMSETE controller (Samson's nonlinear unicycle law)
+         * correcting the along track, cross track and heading error on top of the drive profile's wheel
+         * velocity feedforward. It does not cut corners and needs no lookahead. Once the profile ends it
+         * closes in on the end with the lateral PID and settles on the lateral exits. Raw path.jerryio text
+         * has no timing and is always followed with pure pursuit.
+         */
+        void follow(const asset& path, int timeout, FollowParams params, bool async = true);
+
+        // The LemLib motions, recording their target for lateralError and angularError
+        void turnToPoint(float x, float y, int timeout, lemlib::TurnToPointParams params = {}, bool async = true);
+        void turnToHeading(float theta, int timeout, lemlib::TurnToHeadingParams params = {}, bool async = true);
+        void swingToHeading(float theta, lemlib::DriveSide lockedSide, int timeout,
+                            lemlib::SwingToHeadingParams params = {}, bool async = true);
+        void swingToPoint(float x, float y, lemlib::DriveSide lockedSide, int timeout,
+                          lemlib::SwingToPointParams params = {}, bool async = true);
+        void moveToPose(float x, float y, float theta, int timeout, lemlib::MoveToPoseParams params = {},
+                        bool async = true);
+        void moveToPoint(float x, float y, int timeout, lemlib::MoveToPointParams params = {}, bool async = true);
+
+        /**
+         * @brief Drive straight to a point along a jerk limited velocity profile
+         *
+         * Plans an S-curve from the current velocity to params.endVelocity over the distance to the point and
+         * tracks it with feedforward (kS, kV, kA) plus feedback on the position and velocity error, steering
+         * with the angular PID. Replaces chaining moveToPoint calls with minSpeed/earlyExitRange and maxSpeed to
+         * shape the speed. A motion with no end velocity settles on the lateral exit conditions once the
+         * profile is done.
+         */
+        void profiledMoveToPoint(float x, float y, int timeout, ProfiledMoveParams params = {}, bool async = true);
+
+        /**
+         * @brief Run several motions as one, without stopping between them
+         *
+         * Consecutive points and paths driven in the same direction become one path with the corners
+         * rounded off. Its velocities are planned ahead from the corner curvature and the acceleration
+         * limits, so the robot only slows as much as each corner needs, and it is tracked with pure pursuit
+         * and the drive profile's feedforward. The robot stops to turn in place for heading and swing steps,
+         * when the direction of travel reverses, and before a path that starts well off its heading; turns
+         * in the middle of a chain hand over as soon as they are within the large angular error.
+         *
+         * distTraveled (and so waitUntil) counts the distance along all of the chain's paths. The timeout
+         * covers the whole chain.
+         */
+        void chain(std::vector<ChainStep> steps, int timeout, ChainParams params = {}, bool async = true);
+
+        /**
+         * @brief Error of the running motion, 0 when there is none
+         *
+         * Lateral error is the distance left to the target along the robot's heading (inches), or the path
+         * left to follow. Angular error is how far the robot has to turn to face the target or reach the
+         * target heading (degrees). These are what the motion's PIDs act on, worked out from the pose.
+         */
+        float lateralError();
+        float angularError();
+
+        // forward velocity of the drive from the motor encoders, in/s
+        float forwardVelocity() const;
+
+        // Track the pose with an Odometry filter instead of LemLib's odometry (don't calibrate() then).
+        // setPose restarts the filter at the new pose.
+        void setOdometry(Odometry* odometry);
+        void setPose(float x, float y, float theta, bool radians = false);
+        void setPose(lemlib::Pose pose, bool radians = false);
+
+        // Covariance of getPose() (x, y in inches, heading in radians) from the filter, zero without one
+        PoseCovariance getCovariance();
+
+        /**
+         * @brief Run a callback once the running motion has traveled a distance
+         *
+         * Triggers belong to the motion running when they are added and are checked every cycle of its
+         * control loop, so the routine can go straight on to queue the next motion instead of blocking in
+         * waitUntil. A trigger the motion never reaches runs when the motion ends, cancelled or not, like the
+         * code after a waitUntil would; with no motion running the callback runs straight away. Callbacks
+         * run on the motion's task, so they should only set outputs and state, not wait.
+         *
+         * @param distance inches driven, or degrees turned for turns (distTraveled, like waitUntil)
+         */
+        void at(float distance, std::function<void()> callback);
+
+        // Run a callback once the robot is within radius inches of (x, y), see at()
+        void whenWithin(float x, float y, float radius, std::function<void()> callback);
+
+        // Run a callback once the running motion has closed a fraction (0 - 1) of the error it started with:
+        // the distance or angle to its target, or the path left. Chains change targets as they go; use at or
+        // whenWithin on those. See at()
+        void onProgress(float fraction, std::function<void()> callback);
+
+        // Post trigger callbacks to an executor instead of running them on the motion's task, so the
+        // coroutines on it see the changes between their own steps. nullptr goes back to the motion's task.
+        void runTriggersOn(co::Executor* executor);
+
+        // Coroutine versions of waitUntil and waitUntilDone, for routines on a co::Executor
+        co::Task travelled(float distance);
+        co::Task done();
+    private:
+        struct Trigger {
+            enum class Kind { DISTANCE, WITHIN, PROGRESS } kind;
+            float x = 0; // WITHIN
+            float y = 0;
+            float value = 0; // distance, radius or fraction
+            std::function<void()> callback;
+        };
+        struct Target {
+            enum class Kind { NONE, POINT, FACE, HEADING, PATH } kind = Kind::NONE;
+            float x = 0; // point to drive to (POINT) or face (FACE), the lookahead point (PATH)
+            float y = 0;
+            float theta = 0; // heading to turn to, degrees
+            float remaining = 0; // path left to follow, inches
+            bool forwards = true;
+        };
+
+        // A LemLib motion start() is running on a task, see driveCommanded()
+        struct Wrapped {
+            pros::task_t task;
+            Target target;
+            int triggers = 0; // its triggers once its loop has started, 0 before
+        };
+
+        // Run a LemLib motion on this task, noting its target and checking its triggers from its loop
+        template <typename Motion> void start(const Target& next, bool async, Motion motion);
+
+        // Every command the left side of the drive is sent: a cycle of the wrapped LemLib motion on this task,
+        // if there is one
+        void driveCommanded();
+
+        void setTarget(const Target& next);
+        Target getTarget();
+
+        // Triggers of the running motion: open them as it starts, check them every cycle, and run whatever is
+        // left as it ends. Opening runs what the motion before left if its end has not been seen yet; finishing
+        // does nothing once the next motion has opened them
+        void addTrigger(Trigger trigger);
+        int beginTriggers();
+        void updateTriggers();
+        void finishTriggers(int opened);
+        void runTrigger(std::function<void()> callback);
+
+        // drive profile feedforward for one side of the drive, motor units
+        float feedforward(float velocity, float acceleration) const;
+
+        // The trackers of follow(), false once cancelled or out of time
+        bool pursue(path::PathView& points, float lookahead, bool forwards, lemlib::Timer& timer,
+                    const std::function<void()>& near);
+        bool ramsete(path::PathView& points, const FollowParams& params, lemlib::Timer& timer,
+                     const std::function<void()>& near);
+
+        // Parts of chain(), false once the chain is cancelled or out of time. The last part settles, calling
+        // near when it gets within its large error range.
+        bool chainTurn(const ChainStep& step, float tolerance, bool settle, lemlib::Timer& timer,
+                       const std::function<void()>& near);
+        bool chainDrive(const std::vector<PathSample>& samples, bool forwards, float acceleration, float lookahead,
+                        bool settle, float distanceOffset, lemlib::Timer& timer, const std::function<void()>& near);
+
+        Target target;
+        pros::Mutex targetMutex;
+        std::vector<Trigger> triggers;
+        bool triggersOpen = false; // a motion is taking triggers
+        float initialError = -1; // of the running motion, for PROGRESS triggers; -1 until first checked
+        int triggersOpened = 0; // times beginTriggers ran, so a motion can tell whether they are still its own
+        pros::Mutex triggerMutex;
+        co::Executor* triggerExecutor = nullptr;
+        std::vector<Wrapped*> wrapped; // on the stacks of the start() calls in progress
+        std::atomic<int> wrapping = 0; // wrapped.size(), read without the mutex on every drive command
+        pros::Mutex wrappedMutex;
+        Odometry* odometry = nullptr;
+        DriveProfile profile;
+    };
+}
+
+#endif
@@ -0,0 +1,79 @@
+// colorsort.hpp
+#include "api.h"
+#include "ringsensor.hpp"
+#include <array>
+
+#ifndef COLORSORT_HPP
+#define COLORSORT_HPP
+
+namespace robot {
+    // Where the rings are thrown, in degrees of intake travel
+    struct ColorSortSettings {
+        ColorSortSettings(float ejectDistance, float lateness, uint32_t ejectTime)
+            : ejectDistance(ejectDistance),
+              lateness(lateness),
+              ejectTime(ejectTime) {}
+
+        float ejectDistance; // from the optical sensor seeing a ring's leading edge to the stop that throws it
+        float lateness; // a ring this far past its stop has gone over the top, stopping now would throw the next
+        uint32_t ejectTime; // ms the intake stays stopped for the ring to fly off
+    };
+
+    /**
+     * Throws rings of the other alliance's color off the top of the intake.
+     *
+     * Every ring the RingSensor detects is queued with the intake travel at which it reached the sensor,
+     * so any number of rings can be between the sensor and the top. When a rejected ring has travelled
+     * ejectDistance the intake is stopped for ejectTime; the rings behind it stop with the intake and keep
+     * their places. Running the intake backwards moves them back down, and rings pushed back past the
+     * sensor are forgotten. Driver control and autonomous both feed it every tick, whatever the intake is
+     * doing, and drive the intake themselves: it only says when to stop.
+     */
+    class ColorSort {
+    public:
+        ColorSort(ColorSortSettings settings, RingSensor* sensor);
+
+        // Throw out rings of this color, NONE to keep everything
+        void setRejected(RingColor color);
+        RingColor getRejected();
+
+        /**
+         * @brief Take in the rings detected since the last call and check the one nearest the top
+         *
+         * @param travel intake position in degrees, increasing as it takes rings in
+         * @return true while the intake has to stay stopped for an eject
+         */
+        bool update(double travel);
+
+        // Forget the rings on the intake
+        void clear();
+
+        uint32_t getSeen(); // rings the sensor picked up
+        uint32_t getEjected(); // stops made to throw one out
+    private:
+        struct Ring {
+            double travel; // intake travel when its leading edge reached the sensor
+            RingColor color;
+        };
+
+        // at most three rings fit between the sensor and the top
+        static constexpr size_t CAPACITY = 8;
+
+        void push(const Ring& ring);
+
+        ColorSortSettings settings;
+        RingSensor* sensor;
+        RingColor rejected = RingColor::NONE;
+        std::array<Ring, CAPACITY> rings {};
+        size_t first = 0; // oldest ring, the nearest to the top
+        size_t count = 0;
+        double lastTravel = 0; // at the last update
+        bool started = false;
+        bool ejecting = false;
+        uint32_t ejectEnd = 0;
+        uint32_t seen = 0;
+        uint32_t ejected = 0;
+    };
+}
+
+#endif
@@ -1,6 +1,14 @@
 // config.hpp
 #include "pros/apix.h"
 #include "lemlib/api.hpp"
+#include "armcontroller.hpp"
+#include "chassis.hpp"
+#include "colorsort.hpp"
+#include "devices.hpp"
+#include "drive.hpp"
+#include "jamdetector.hpp"
+#include "odometry.hpp"
+#include "relocalize.hpp"
 
 #ifndef CONFIG_HPP
 #define CONFIG_HPP
@@ -11,33 +19,67 @@ namespace robot {
     extern pros::Controller partnerController;
 
     namespace drivetrain {
-        extern lemlib::Chassis chassis;
+        extern robot::CachedMotorGroup leftMotors;
+        extern robot::CachedMotorGroup rightMotors;
+        extern robot::Chassis chassis;
+        extern robot::Odometry odometry;
+        extern robot::Relocalizer relocalizer;
+        extern pros::Gps gps;
+        extern robot::GpsSettings gpsSettings;
     }
 
     namespace mechanisms {
-        extern pros::Motor lbMotor;
-        extern pros::Motor intakeMotor;
+        extern robot::CachedMotor lbMotor;
+        extern robot::CachedMotor intakeMotor;
         
         // Pneumatics/Digital outputs
-        extern pros::ADIDigitalOut hang;
-        extern pros::ADIDigitalOut clamp;
-        extern pros::ADIDigitalOut doinker;
-        extern pros::ADIDigitalOut intake;
+        extern robot::CachedDigitalOut hang;
+        extern robot::CachedDigitalOut clamp;
+        extern robot::CachedDigitalOut doinker;
+        extern robot::CachedDigitalOut intake;
 
         // Sensors/Digital inputs
         extern pros::Rotation lbRotationSensor;
         extern pros::Optical opticalSensor;
-        extern pros::Distance distanceSensor;
+
+        extern robot::RingSensor ringSensor;
+        extern robot::ColorSort colorSort;
+        extern robot::ArmController lbController;
+        extern robot::JamDetector intakeJam;
     }
 
     namespace pid {
-        extern lemlib::PID lbPID;
+        extern lemlib::PID lbPID; // the LB's velocity loop, without constants::ARM_CONTROLLER
     }
 
     // Constants 
     namespace constants {
         constexpr int INTAKE_SPEED = 600;
         constexpr int LOOP_DELAY = 25;
+        // track the pose with robot::Odometry (IMU, tracking wheel and drive encoders) instead of LemLib's odometry.
+        // Off until its noise figures have been tuned on the robot, they are only checked against the simulator:
+        // build with make EKF=1 to try it
+#ifdef EKF
+        constexpr bool EKF_ODOMETRY = true;
+#else
+        constexpr bool EKF_ODOMETRY = false;
+#endif
+        // also fuse the GPS sensor into it, for long runs where the drift adds up. Off until the sensor is on
+        // the robot: port 5 and its offset in config.cpp are placeholders
+        constexpr bool GPS_FUSION = false;
+        // trim x and y from the walls the distance sensors see. Off until the sensors are fitted and measured:
+        // ports 2-4 and their offsets in config.cpp are placeholders. Skills resets its pose by hand without it
+        constexpr bool RELOCALIZE = false;
+        // throw the other alliance's rings off the top of the intake, in driver control and autonomous
+        constexpr bool COLOR_SORT = true;
+        // tell rings apart by their red, green and blue fractions instead of the hue. Off until the fractions in
+        // config.cpp have been measured from real rings
+        constexpr bool RING_FRACTIONS = false;
+        // back the intake off when a ring jams it, in driver control and autonomous
+        constexpr bool JAM_RECOVERY = true;
+        // move the LB with robot::ArmController instead of the velocity loop (pid::lbPID). Off until the real
+        // arm is characterized: the gains in config.cpp fit the simulator's LB
+        constexpr bool ARM_CONTROLLER = false;
     }
 
     namespace lb {
@@ -0,0 +1,231 @@
+// coroutine.hpp
+//
+// Cooperative runtime for the autonomous routines. The routine and the
+// mechanism controllers are coroutines resumed one after another on each tick
+// of a single task, so they share state without locks:
+//
+//     robot::co::Task routine() {
+//         chassis.moveToPoint(0, 24, 1000);
+//         co_await chassis.travelled(12);
+//         autosetting::run_intake(1000);
+//         co_await robot::co::sleep(200);
+//         co_await chassis.done();
+//     }
+//
+// all, race, sequence and withTimeout combine steps, e.g. drive and score at
+// once and move on when both are done:
+//
+//     co_await robot::co::all(chassis.done(), robot::co::withTimeout(autosetting::run_LB_to(18000), 800));
+#include "api.h"
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <vector>
+
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+namespace robot::co {
+    class Executor;
+
+    /**
+     * A coroutine run by an Executor.
+     *
+     * It does not start when called: co_await it from another Task to run it there and continue once it
+     * returns, or hand it to Executor::spawn or Executor::run. An exception it throws comes out of the
+     * co_await (or Executor::run).
+     */
+    class Task {
+    public:
+        struct promise_type;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        struct promise_type {
+            std::coroutine_handle<> continuation; // resumed when this one returns, none for a root
+            promise_type* root = this; // outermost coroutine of the chain this one runs in
+            promise_type* owner = nullptr; // for a root started by all or race, the coroutine that started it
+            Executor* executor = nullptr; // set on the root
+            const char* waiting = "other"; // what the chain is waiting on, set on the root
+            std::exception_ptr exception;
+
+            Task get_return_object() { return Task(Handle::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept {
+                struct Continue {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(Handle finished) noexcept {
+                        const std::coroutine_handle<> next = finished.promise().continuation;
+                        return next ? next : std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                return Continue{};
+            }
+            void return_void() {}
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        // Destroying an unfinished root (one that is spawned, run or started by all/race) stops it
+        Task(Task&& other) noexcept;
+        Task& operator=(Task&& other) noexcept;
+        ~Task();
+
+        bool done() const { return !handle || handle.done(); }
+
+        bool await_ready() const noexcept { return done(); }
+        std::coroutine_handle<> await_suspend(Handle awaiting) noexcept;
+        void await_resume();
+    private:
+        explicit Task(Handle handle)
+            : handle(handle) {}
+
+        friend class Executor;
+        friend class Join;
+        Handle handle;
+    };
+
+    // Suspends the awaiting Task until a condition holds, checked once per executor tick
+    class Until {
+    public:
+        /**
+         * @param ready checked before suspending (unless check is false) and then every tick
+         * @param name what the routine is doing meanwhile, for the simulator's time budget
+         */
+        Until(std::function<bool()> ready, const char* name, bool check = true);
+
+        bool await_ready() { return check && ready(); }
+        void await_suspend(Task::Handle awaiting);
+        void await_resume() const noexcept {}
+    private:
+        std::function<bool()> ready;
+        const char* name;
+        bool check;
+    };
+
+    // Resume once condition() holds
+    Until until(std::function<bool()> condition, const char* name = "until");
+
+    // Resume after the given time from when it is awaited, rounded up to the next tick
+    Task sleep(uint32_t milliseconds);
+
+    // Resume on the next tick
+    Until tick(const char* name = "tick");
+
+    // Runs child Tasks alongside the awaiting one, resuming it once all or any of them have returned
+    class Join {
+    public:
+        enum class Mode { ALL, ANY };
+
+        Join(std::vector<Task>& tasks, Mode mode);
+
+        bool await_ready() const;
+        bool await_suspend(Task::Handle awaiting);
+        // rethrows the first exception of a child that returned
+        void await_resume();
+    private:
+        bool finished() const;
+
+        std::vector<Task>& tasks;
+        Mode mode;
+    };
+
+    // A step for the combinators: a Task as is, or a Task that awaits anything else (Until, ...)
+    inline Task step(Task task) { return task; }
+    template <typename Awaitable> Task step(Awaitable awaitable) { co_await std::move(awaitable); }
+
+    template <typename... Steps> std::vector<Task> steps(Steps... each) {
+        std::vector<Task> tasks;
+        tasks.reserve(sizeof...(each));
+        (tasks.push_back(step(std::move(each))), ...);
+        return tasks;
+    }
+
+    /**
+     * @brief Run steps side by side and return once all of them have
+     *
+     * The steps start in order on the same tick. An exception from one of them is rethrown once the
+     * others are done.
+     */
+    Task all(std::vector<Task> steps);
+    template <typename... Steps> Task all(Steps... each) { return all(steps(std::move(each)...)); }
+
+    /**
+     * @brief Run steps side by side and return as soon as one of them does, stopping the others
+     *
+     * A stopped step is destroyed at the co_await it was waiting in. Whatever it started keeps going:
+     * a motion it was waiting on keeps running, and the mechanisms keep their last command.
+     */
+    Task race(std::vector<Task> steps);
+    template <typename... Steps> Task race(Steps... each) { return race(steps(std::move(each)...)); }
+
+    // Run steps one after another, so a series can be one step of all or race
+    Task sequence(std::vector<Task> steps);
+    template <typename... Steps> Task sequence(Steps... each) { return sequence(steps(std::move(each)...)); }
+
+    // Give up on a step after the given time, like race with sleep
+    template <typename Step> Task withTimeout(Step step, uint32_t milliseconds) {
+        return race(std::move(step), sleep(milliseconds));
+    }
+
+    /**
+     * Runs coroutines cooperatively on one task.
+     *
+     * Each tick (spaced with Task::delay_until) first runs the callbacks posted since the last one, then
+     * resumes every waiting coroutine whose condition holds, in the order they suspended. A coroutine runs
+     * until its next co_await, so a busy or blocking one holds up the rest of the tick.
+     */
+    class Executor {
+    public:
+        // tick is the time between checks in milliseconds
+        explicit Executor(uint32_t tick = 10);
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        // Run a coroutine alongside the others until it returns or the executor stops. Spawned ones start
+        // on the first tick, before the main coroutine of run().
+        void spawn(Task task);
+
+        // Run a callback on the executor's task at the start of the next tick. Safe from any task.
+        void post(std::function<void()> callback);
+
+        // Run the coroutines on the calling task until main returns, rethrowing its exception. The
+        // spawned ones keep their place for start().
+        void run(Task main);
+
+        // Keep running the spawned coroutines on a new task while condition() holds, then destroy them.
+        // The executor must outlive the task.
+        void start(const char* name, std::function<bool()> condition = [] { return true; });
+
+        // Forget everything left by a run whose task was deleted part way, e.g. at the end of the
+        // autonomous period. Their frames are leaked, since that task may have been inside one.
+        void reset();
+    private:
+        friend class Until;
+        friend class Join;
+        friend class Task;
+
+        struct Waiter {
+            std::coroutine_handle<> handle; // empty once forgotten
+            std::function<bool()> ready; // resume right away if empty
+            Task::promise_type* root;
+        };
+
+        void adopt(Task& task);
+        void wait(std::coroutine_handle<> handle, std::function<bool()> ready, Task::promise_type* root);
+        // Drop the waiters of a root and of the roots it started, before it is destroyed
+        void forget(Task::promise_type* root);
+        void step();
+        void clear();
+
+        uint32_t tick;
+        uint32_t lastTick = 0; // ms, of the last step run() took
+        std::vector<Task> spawned;
+        std::vector<Waiter> waiters;
+        std::vector<Waiter> due; // being resumed by step()
+        std::vector<std::function<void()>> posted;
+        pros::Mutex postMutex;
+    };
+}
+
+#endif
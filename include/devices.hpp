@@ -0,0 +1,141 @@
+// devices.hpp
+#include "api.h"
+#include <functional>
+
+#ifndef DEVICES_HPP
+#define DEVICES_HPP
+
+namespace robot {
+    /**
+     * The last command written to one setting of a device, so writes that repeat it can be dropped.
+     *
+     * Control loops command their outputs every cycle whether or not anything changed, and each of those
+     * writes is a packet on the smart port or a solenoid toggle request. Writes that fail are not cached,
+     * so they are retried on the next call. A device should only be written from one task at a time.
+     */
+    class CommandCache {
+    public:
+        struct Counters {
+            uint32_t forwarded = 0; // writes that reached the device
+            uint32_t suppressed = 0; // writes dropped because they repeated the last command
+            uint32_t refreshed = 0; // repeated writes forwarded anyway because the refresh period ran out
+        };
+
+        // Kinds of command sharing a setting, e.g. a motor's voltage and velocity targets
+        enum class Kind : uint8_t { NONE, MOVE, VOLTAGE, VELOCITY, BRAKE, VALUE };
+
+        /**
+         * @brief Write through the cache
+         *
+         * @param send performs the device write, returns its PROS result
+         * @return the result of send, or 1 if the write was dropped
+         */
+        template <typename Send> std::int32_t write(Kind kind, std::int32_t value, Send&& send) {
+            const uint32_t now = pros::millis();
+            if (kind == lastKind && value == lastValue) {
+                if (refreshPeriod == 0 || now - sentAt < refreshPeriod) {
+                    totals.suppressed++;
+                    return 1;
+                }
+                totals.refreshed++;
+            }
+            const std::int32_t result = send();
+            totals.forwarded++;
+            if (result == PROS_ERR) {
+                forget();
+            } else {
+                lastKind = kind;
+                lastValue = value;
+                sentAt = now;
+            }
+            return result;
+        }
+
+        // Send the next write whatever it is, e.g. after the device reconnects
+        void forget() { lastKind = Kind::NONE; }
+
+        // Resend an unchanged command once it is this old, 0 to never resend (ms)
+        void setRefresh(uint32_t period) { refreshPeriod = period; }
+
+        static const Counters& counters() { return totals; }
+    private:
+        Kind lastKind = Kind::NONE;
+        std::int32_t lastValue = 0;
+        uint32_t sentAt = 0;
+        uint32_t refreshPeriod = 0;
+
+        static Counters totals;
+    };
+
+    /**
+     * pros::Motor that only forwards commands that differ from the last one.
+     *
+     * Other writes (tare, gearing, ...) pass straight through.
+     */
+    class CachedMotor : public pros::Motor {
+    public:
+        using pros::Motor::Motor;
+
+        std::int32_t move(std::int32_t voltage) const override;
+        std::int32_t move_velocity(std::int32_t velocity) const override;
+        std::int32_t move_voltage(std::int32_t voltage) const override;
+        std::int32_t brake() const override;
+        std::int32_t set_brake_mode(pros::motor_brake_mode_e_t mode, std::uint8_t index = 0) const override;
+        std::int32_t set_brake_mode(pros::MotorBrake mode, std::uint8_t index = 0) const override;
+        std::int32_t set_brake_mode_all(pros::motor_brake_mode_e_t mode) const override;
+        std::int32_t set_brake_mode_all(pros::MotorBrake mode) const override;
+
+        void setRefresh(uint32_t period) const;
+        void forget() const;
+    private:
+        mutable CommandCache output;
+        mutable CommandCache brakeMode;
+    };
+
+    /**
+     * pros::MotorGroup that only forwards commands that differ from the last one.
+     *
+     * Commands to a single motor of the group pass through and make the group's cache forget.
+     */
+    class CachedMotorGroup : public pros::MotorGroup {
+    public:
+        using pros::MotorGroup::MotorGroup;
+
+        std::int32_t move(std::int32_t voltage) const override;
+        std::int32_t move_velocity(std::int32_t velocity) const override;
+        std::int32_t move_voltage(std::int32_t voltage) const override;
+        std::int32_t brake() const override;
+        std::int32_t set_brake_mode(pros::motor_brake_mode_e_t mode, std::uint8_t index = 0) const override;
+        std::int32_t set_brake_mode(pros::MotorBrake mode, std::uint8_t index = 0) const override;
+        std::int32_t set_brake_mode_all(pros::motor_brake_mode_e_t mode) const override;
+        std::int32_t set_brake_mode_all(pros::MotorBrake mode) const override;
+
+        void setRefresh(uint32_t period) const;
+        void forget() const;
+
+        // Call hook on the commanding task after every move, move_velocity, move_voltage and brake, cached
+        // or not: once per cycle of a control loop driving the group, including LemLib's
+        void onCommand(std::function<void()> hook);
+    private:
+        std::int32_t commanded(std::int32_t result) const;
+
+        mutable CommandCache output;
+        mutable CommandCache brakeMode;
+        std::function<void()> hook;
+    };
+
+    // pros::ADIDigitalOut that only forwards changes of the output
+    class CachedDigitalOut : public pros::ADIDigitalOut {
+    public:
+        using pros::ADIDigitalOut::ADIDigitalOut;
+
+        std::int32_t set_value(std::int32_t value) const;
+
+        void setRefresh(uint32_t period) const;
+        void forget() const;
+    private:
+        mutable CommandCache state;
+    };
+}
+
+#endif
@@ -0,0 +1,26 @@
+// drive.hpp
+
+#ifndef DRIVE_HPP
+#define DRIVE_HPP
+
+// The drivetrain and its motion limits, shared by src/config.cpp and tools/pathc.py, which plans the compiled
+// paths' speeds with them. pathc.py reads the "constexpr float NAME = value;" lines of this file, so keep each
+// on one line with a plain number. The makefiles rebuild the paths when it changes
+namespace robot {
+    namespace constants::drive {
+        constexpr float RPM = 450;
+        constexpr float WHEEL_DIAMETER = 3.25; // in
+        constexpr float TRACK_WIDTH = 11.4; // in
+        // limits of the profiled motions and the planned paths
+        constexpr float MAX_VELOCITY = 72; // in/s
+        constexpr float MAX_ACCELERATION = 300; // in/s^2
+        constexpr float MAX_JERK = 4000; // in/s^3
+        constexpr float MAX_LATERAL_ACCELERATION = 300; // in/s^2, about what the wheels grip; paths only
+        // feedforward, in motor units (127 = 12 V); fit with tools/characterize.py
+        constexpr float KS = 3; // to get moving
+        constexpr float KV = 1.66; // per in/s
+        constexpr float KA = 0.2; // per in/s^2
+    }
+}
+
+#endif
@@ -0,0 +1,117 @@
+// flightlog.hpp
+#include "api.h"
+#include "telemetry.hpp"
+#include <atomic>
+#include <cstdio>
+
+#ifndef FLIGHTLOG_HPP
+#define FLIGHTLOG_HPP
+
+namespace robot {
+    /**
+     * 100 Hz binary log of the robot's state to the SD card, for going over autos afterwards.
+     *
+     * A sampling task pushes each sample into a telemetry ring as a FLIGHT record. A low priority writer
+     * task drains the ring into a block and writes full blocks to the card, so a slow SD write never
+     * holds up a sample; if the ring fills up while the writer waits on the card, samples are dropped
+     * and counted. A partly filled block is written out once it is FLUSH_PERIOD old, so a brownout loses at
+     * most that much. Decode the files with tools/flightlog.py.
+     *
+     * File layout (little endian): Header, then `fields` NUL terminated field names, then samples.
+     */
+    class FlightLog {
+    public:
+        static constexpr char MAGIC[4] = {'F', 'L', 'O', 'G'};
+        static constexpr uint16_t VERSION = 1;
+        static constexpr uint32_t PERIOD = 10; // ms between samples
+        static constexpr uint32_t BLOCK_SIZE = 4096; // bytes
+        static constexpr uint32_t FLUSH_PERIOD = 1000; // ms a partly filled block waits to be written out
+
+        struct Header {
+            char magic[4];
+            uint16_t version;
+            uint16_t sampleSize; // bytes
+            uint16_t fields;
+            uint16_t period; // ms
+        };
+
+        // Version 1. Bump VERSION and teach the decoder when this changes.
+        struct Sample {
+            uint32_t time; // ms since the brain started
+            float x; // inches
+            float y;
+            float theta; // degrees
+            float leftVelocity; // rpm, average of the side
+            float rightVelocity;
+            float leftCurrent; // mA, total of the side
+            float rightCurrent;
+            float lateralError; // inches
+            float angularError; // degrees
+            float intakeVelocity; // rpm
+            float hue; // degrees
+            float lbPosition; // centidegrees
+        };
+
+        static constexpr const char* FIELD_NAMES[] = {
+            "time", "x", "y", "theta", "left_velocity", "right_velocity", "left_current", "right_current",
+            "lateral_error", "angular_error", "intake_velocity", "hue", "lb_position"
+        };
+        static constexpr int FIELDS = sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]);
+
+        static_assert(sizeof(Header) == 12, "must match tools/flightlog.py");
+        static_assert(sizeof(Sample) == FIELDS * 4, "must match tools/flightlog.py");
+        static_assert(FIELDS - 1 <= telemetry::MAX_FIELDS, "a sample but its time goes in one record");
+
+        struct Counters {
+            uint32_t samples = 0; // samples pushed into the ring
+            uint32_t dropped = 0; // samples lost because the ring was full
+            uint32_t blocks = 0; // blocks written to the card
+            uint32_t maxWrite = 0; // longest block write, us
+        };
+
+        FlightLog();
+
+        // Directory the log files go in, "/usd" unless set before start
+        void setDirectory(const char* directory) { this->directory = directory; }
+        const char* getDirectory() const { return directory; }
+
+        /**
+         * @brief Open the next free <directory>/flightNNN.bin and log to it
+         *
+         * Starts the sampling and writer tasks the first time. Does nothing while a file is open.
+         *
+         * @return false if there is no SD card or no free file name; nothing is logged then
+         */
+        bool start();
+
+        // Write out what is left and close the file, e.g. when the robot gets disabled. Waits for the writer task
+        void stop();
+
+        bool running() const { return logging; }
+
+        const Counters& counters() const { return totals; }
+    private:
+        // Sampling task: read the devices and push one sample
+        void sample();
+        // Writer task: append a drained sample to the block, writing it out first if it is full
+        void store(const telemetry::Record& record);
+        // Writer task: write out the block
+        void writeBlock();
+
+        const char* directory = "/usd";
+        std::atomic<FILE*> file = nullptr; // opened by start(), written and closed by the writer task
+        std::atomic<bool> logging = false;
+        std::atomic<bool> closeRequested = false;
+        bool tasksStarted = false;
+        telemetry::Ring<256> samples; // 2.56 s of samples to ride out a slow write
+        telemetry::Drainer writer;
+        uint32_t used = 0; // bytes of the block
+        uint32_t writtenAt = 0; // ms, when the last block was written
+        uint8_t block[BLOCK_SIZE];
+        Counters totals;
+    };
+
+    extern FlightLog flightLog;
+}
+
+#endif
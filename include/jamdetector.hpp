@@ -0,0 +1,94 @@
+// jamdetector.hpp
+#include "api.h"
+#include "telemetry.hpp"
+
+#ifndef JAMDETECTOR_HPP
+#define JAMDETECTOR_HPP
+
+namespace robot {
+    // What counts as a jam and how to clear it
+    struct JamSettings {
+        JamSettings(float minCommand, float stallFraction, float recoverFraction, int32_t minCurrent, float minTorque,
+                    uint32_t jamTime, uint32_t spinUpTime, float reverseSpeed, uint32_t reverseTime,
+                    int maxAttempts)
+            : minCommand(minCommand),
+              stallFraction(stallFraction),
+              recoverFraction(recoverFraction),
+              minCurrent(minCurrent),
+              minTorque(minTorque),
+              jamTime(jamTime),
+              spinUpTime(spinUpTime),
+              reverseSpeed(reverseSpeed),
+              reverseTime(reverseTime),
+              maxAttempts(maxAttempts) {}
+
+        float minCommand; // rpm, slower commands are never checked
+        float stallFraction; // stalled while turning slower than this fraction of the command
+        float recoverFraction; // running again once back over this fraction of the command
+        int32_t minCurrent; // mA, a stall draws at least this much...
+        float minTorque; // Nm, ...or pushes this hard
+        uint32_t jamTime; // ms stalled before it is a jam
+        uint32_t spinUpTime; // ms after the motor is started or turned around before stalls count
+        float reverseSpeed; // rpm, backing off a jam
+        uint32_t reverseTime; // ms, the first attempt; the nth backs off n times as long
+        int maxAttempts; // reverses for one jam before giving up on it
+    };
+
+    /**
+     * Notices a mechanism stalling on a jam and backs it off.
+     *
+     * A stall is the motor turning under stallFraction of the commanded velocity while drawing minCurrent
+     * or pushing minTorque; one that lasts jamTime is a jam. The motor is then run backwards for
+     * reverseTime, longer on each attempt, and resumed, up to maxAttempts times. The jam is over once the
+     * motor is back over recoverFraction of the command past where it stalled, or is no longer asked to
+     * run. After maxAttempts the motor is left to the command until that stops or turns around. Stalls
+     * don't count for spinUpTime after the command starts, turns around or resumes, while the motor draws
+     * its starting current. Driver control and autonomous both pass every velocity command through
+     * update(), after the color sort's eject, so an eject stop is never taken for a jam. Each jam is
+     * logged to telemetry::log() with how long it lasted; only one task may call update() at a time.
+     */
+    class JamDetector {
+    public:
+        struct Counters {
+            uint32_t jams = 0;
+            uint32_t cleared = 0; // got running again
+            uint32_t reverses = 0;
+            uint32_t jammedTime = 0; // ms, from each stall to the end of its jam
+            uint32_t longest = 0; // ms
+        };
+
+        JamDetector(pros::Motor* motor, JamSettings settings);
+
+        /**
+         * @brief Check the motor and say what to command it
+         *
+         * @param command velocity the caller wants, rpm
+         * @return the command, or the reverse velocity while backing off a jam
+         */
+        double update(double command);
+
+        bool isJammed(); // between a jam being found and its end
+        bool isReversing();
+        const Counters& counters() const { return totals; }
+    private:
+        void end(uint32_t now, const char* outcome); // outcome: a string literal, see telemetry::intern
+
+        pros::Motor* motor;
+        JamSettings settings;
+        double lastCommand = 0;
+        uint32_t spinUpEnd = 0; // stalls count from here on
+        uint32_t stallStart = 0; // 0 when not stalled
+        bool jammed = false;
+        uint32_t jamStart = 0; // when the first stall of the jam began
+        double jamPosition = 0; // motor position it stalled at
+        int attempts = 0;
+        bool gaveUp = false;
+        bool reversing = false;
+        uint32_t reverseEnd = 0;
+        double reverseCommand = 0;
+        Counters totals;
+        telemetry::Ring<16> reports;
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+// motionprofile.hpp
+#include <vector>
+
+#ifndef MOTIONPROFILE_HPP
+#define MOTIONPROFILE_HPP
+
+namespace robot {
+    // Limits a profile plans within
+    struct ProfileLimits {
+        float velocity; // in/s
+        float acceleration; // in/s^2
+        float jerk; // in/s^3
+    };
+
+    /**
+     * Jerk limited ("double S") velocity profile along a fixed distance.
+     *
+     * Starts at one velocity and ends at another, accelerating with a bounded jerk up to at most the
+     * velocity limit, cruising, then decelerating the same way. The phase times are solved in closed
+     * form (Biagiotti & Melchiorri, Trajectory Planning for Automatic Machines and Robots, 3.4) when the
+     * profile is made, so evaluating it is a handful of multiplications.
+     *
+     * Velocities are not negative; drive backwards by flipping the output. If the distance is too short
+     * to reach the requested end velocity, the profile ends at the closest one it can reach.
+     */
+    class SCurve {
+    public:
+        struct State {
+            float position; // in from the start
+            float velocity; // in/s
+            float acceleration; // in/s^2
+        };
+
+        SCurve(float distance, float startVelocity, float endVelocity, ProfileLimits limits);
+
+        // State t seconds after the start, held at the end state after duration()
+        State at(float t) const;
+
+        float duration() const { return accelTime + cruiseTime + decelTime; }
+        float distance() const { return length; }
+        float endVelocity() const { return end; }
+        float peakVelocity() const { return peak; }
+    private:
+        // Solve the phase times for the given limits, false if the end velocity is out of reach
+        bool plan(ProfileLimits limits);
+
+        float length;
+        float start;
+        float end;
+        float jerk;
+        float accelTime = 0; // Ta, including the jerk phases
+        float cruiseTime = 0; // Tv
+        float decelTime = 0; // Td
+        float accelJerkTime = 0; // Tj1
+        float decelJerkTime = 0; // Tj2
+        float accelLimit = 0; // reached acceleration
+        float decelLimit = 0; // reached deceleration, negative
+        float peak = 0; // cruise velocity
+    };
+
+    // A point along a planned path
+    struct PathSample {
+        float x;
+        float y;
+        float distance; // arc length from the first sample, inches
+        float curvature; // 1/inches, positive when the path turns clockwise
+        float velocity; // in/s
+    };
+
+    /**
+     * Fastest velocities along a path under acceleration limits.
+     *
+     * Each sample's velocity, filled in beforehand with its own cap, is further capped by the velocity
+     * limit, by lateralAcceleration on its curvature, and by the outer wheel reaching the velocity limit. A
+     * forward then a backward pass keep the acceleration between samples under the limit, starting from
+     * startVelocity and ending at endVelocity. The velocities change with bounded acceleration, not
+     * bounded jerk.
+     */
+    void planVelocity(std::vector<PathSample>& samples, ProfileLimits limits, float lateralAcceleration,
+                      float trackWidth, float startVelocity, float endVelocity);
+}
+
+#endif
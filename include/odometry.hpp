@@ -0,0 +1,149 @@
+// odometry.hpp
+#include "api.h"
+#include "lemlib/api.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include <array>
+
+#ifndef ODOMETRY_HPP
+#define ODOMETRY_HPP
+
+namespace robot {
+    // Sensors the filter fuses. The drive sides are read as tracking wheels on the drive motors.
+    struct OdometrySensors {
+        pros::Imu* imu;
+        lemlib::TrackingWheel* vertical; // tracking wheel along the drive
+        lemlib::TrackingWheel* left; // drive motors, offset left (negative)
+        lemlib::TrackingWheel* right; // drive motors, offset right
+    };
+
+    // Standard deviations the filter assumes
+    struct OdometryNoise {
+        OdometryNoise(float acceleration, float angularAcceleration, float imuHeading, float imuDrift,
+                      float gyroRate, float trackingWheel, float drift, float driveEncoder, float slipGate)
+            : acceleration(acceleration),
+              angularAcceleration(angularAcceleration),
+              imuHeading(imuHeading),
+              imuDrift(imuDrift),
+              gyroRate(gyroRate),
+              trackingWheel(trackingWheel),
+              drift(drift),
+              driveEncoder(driveEncoder),
+              slipGate(slipGate) {}
+
+        float acceleration; // in/s^2, how fast the speed changes between updates
+        float angularAcceleration; // rad/s^2
+        float imuHeading; // rad
+        float imuDrift; // deg the IMU heading may wander in a minute
+        float gyroRate; // rad/s
+        float trackingWheel; // in/s, of its travel
+        float drift; // in, how far off x and y may be after driving 100 in (wheel size, scrub)
+        float driveEncoder; // in/s, each side
+        float slipGate; // normalised innovation squared of the drive sides (2 degrees of freedom) counted as slip
+    };
+
+    // How the GPS readings are taken
+    struct GpsSettings {
+        GpsSettings(uint32_t latency, float maxError, float headingDeviation, float rotation, float gate)
+            : latency(latency),
+              maxError(maxError),
+              headingDeviation(headingDeviation),
+              rotation(rotation),
+              gate(gate) {}
+
+        uint32_t latency; // ms a reading lags the robot
+        float maxError; // in, readings the GPS rates worse than this are left out (it can't see the strip)
+        float headingDeviation; // deg
+        float rotation; // deg clockwise from our +y to the GPS's, 0 when the field is set up as in path.jerryio
+        float gate; // normalised innovation squared of a reading (3 degrees of freedom) over which it is left out
+    };
+
+    // x, y (inches) and heading (radians) covariance, in that order
+    using PoseCovariance = std::array<std::array<float, 3>, 3>;
+
+    /**
+     * Extended Kalman filter odometry, run in place of LemLib's odometry task.
+     *
+     * The state is the pose, the forward and turning speed and the IMU's heading drift (x, y, theta, v,
+     * omega, bias); the drift is only seen against an absolute heading such as the GPS. Each update moves
+     * the pose by the tracking wheel's travel along the predicted heading, then corrects the heading and
+     * speeds with the IMU heading and gyro rate, the tracking wheel's speed and, every 10 ms when the
+     * motors report, the speed of each drive side. Drive sides too far from the prediction (normalised
+     * innovation squared over slipGate) are taken as wheel slip, say pushing into a wall, and left out.
+     * The estimate is written to LemLib every update, so getPose() and the motions see it.
+     */
+    class Odometry {
+    public:
+        Odometry(OdometrySensors sensors, OdometryNoise noise, float gyroSign = -1);
+
+        // Calibrate the IMU, reset the wheels and start the filter task; period in milliseconds
+        void start(uint32_t period = 5);
+
+        // Restart the estimate at a pose (degrees), trusting it exactly
+        void setPose(lemlib::Pose pose);
+
+        // Fuse a direct reading of x or y (inches) with the given standard deviation, e.g. from a wall
+        void correctX(float x, float deviation);
+        void correctY(float y, float deviation);
+
+        /**
+         * @brief Also fuse the position and heading of a GPS sensor, nullptr to stop
+         *
+         * Each reading is weighted by the error the GPS reports for it and compared with the estimate from
+         * latency ago, so its lag doesn't pull the pose back along the path. Readings rated worse than
+         * maxError, or none at all (the sensor can't see the field strip), are skipped until it recovers.
+         * So are readings too far from the estimate for how sure both are (normalised innovation squared of
+         * x, y and heading over gate), such as a pose set in a mirrored copy of the field.
+         */
+        void setGps(pros::Gps* gps, GpsSettings settings);
+        pros::Gps* getGps(); // nullptr when none is fused
+
+        lemlib::Pose getPose(bool radians = false);
+        PoseCovariance getCovariance();
+
+        // the drive sides disagreed with the estimate on the last check, and how often that started
+        bool isSlipping();
+        uint32_t getSlipCount();
+        // GPS readings left out for being too far from the estimate
+        uint32_t getGpsRejected();
+    private:
+        static constexpr int STATES = 6;
+        using Vector = std::array<float, STATES>;
+        using Matrix = std::array<Vector, STATES>;
+
+        void update(float dt, bool readDrive);
+        void predict(float dt, float distance);
+        // correct with a scalar measurement z = h.x + noise of the given variance
+        void correct(const Vector& h, float z, float variance);
+        void publish();
+        void correctGps();
+
+        OdometrySensors sensors;
+        OdometryNoise noise;
+        float gyroSign; // turns the IMU's z rate into clockwise positive
+        Vector state {};
+        Matrix covariance {};
+        float headingOffset = 0; // rad, pose heading minus IMU rotation
+        float lastVertical = 0;
+        float lastLeft = 0;
+        float lastRight = 0;
+        float driveTime = 0; // s since the drive sides were last read
+        bool slipping = false;
+        uint32_t slipCount = 0;
+        pros::Gps* gps = nullptr;
+        GpsSettings gpsSettings = {0, 0, 0, 0, 0};
+        float gpsTime = 0; // s since the GPS was last read
+        uint32_t gpsRejected = 0;
+        // past poses, for matching GPS readings to when they were taken
+        struct Past {
+            uint32_t time; // ms
+            float x;
+            float y;
+            float theta;
+        };
+        std::array<Past, 64> history {};
+        size_t historyEnd = 0; // next slot to write
+        pros::Mutex mutex;
+    };
+}
+
+#endif
@@ -0,0 +1,94 @@
+// path.hpp
+//
+// Paths compiled at build time from the path.jerryio exports in static/
+// (see tools/pathc.py). The image holds a small header followed by packed
+// float waypoints, so following a path does not parse anything on the robot.
+#ifndef PATH_HPP
+#define PATH_HPP
+
+#include "lemlib/asset.hpp"
+#include <cstdint>
+#include <cstring>
+
+// Declares the compiled form of static/<name>.txt as an asset named <name>_path, e.g.
+// PATH_ASSET(Skill1) -> Skill1_path
+#define PATH_ASSET(x)                                                                                                  \
+    extern "C" {                                                                                                       \
+    extern uint8_t _binary_static_##x##_path_start[], _binary_static_##x##_path_size[];                                \
+    static asset x##_path = {_binary_static_##x##_path_start, (size_t)_binary_static_##x##_path_size};                 \
+    }
+
+namespace robot::path {
+    constexpr char MAGIC[4] = {'P', 'A', 'T', 'H'};
+    constexpr uint16_t VERSION = 3;
+
+    struct Header {
+        char magic[4];
+        uint16_t version;
+        uint16_t count;
+        float length; // inches
+    };
+
+    struct Waypoint {
+        float x;
+        float y;
+        float speed; // 0 - 127, 0 marks the end of the path
+        float distance; // arc length from the first waypoint, inches
+        float curvature; // 1/inches, positive when the path turns clockwise
+        float time; // seconds from the start when driven at the planned speeds
+    };
+
+    static_assert(sizeof(Header) == 12 && sizeof(Waypoint) == 24, "must match tools/pathc.py");
+
+    // Whether the asset holds a compiled path rather than path.jerryio text
+    inline bool isCompiled(const asset& path) {
+        if (path.size < sizeof(Header)) return false;
+        Header header;
+        std::memcpy(&header, path.buf, sizeof(Header));
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+               header.count >= 2 && path.size >= sizeof(Header) + header.count * sizeof(Waypoint);
+    }
+
+    /**
+     * @brief Pure pursuit queries over a compiled path, read in place
+     *
+     * The assets are linked 4 byte aligned, so the waypoints are used straight from the image. Both searches
+     * keep a cursor that only moves forward along the path, so each control cycle only looks at the waypoints
+     * near the robot instead of the whole path. Use one view per traversal.
+     */
+    class PathView {
+    public:
+        // the asset must be compiled (see isCompiled)
+        explicit PathView(const asset& path);
+
+        int size() const { return header->count; }
+        float length() const { return header->length; }
+        const Waypoint& operator[](int i) const { return points[i]; }
+        const Waypoint& back() const { return points[size() - 1]; }
+
+        /**
+         * @brief Index of the waypoint closest to (x, y)
+         *
+         * Only waypoints from the previous result up to window inches of arc length past it are
+         * considered.
+         */
+        int closest(float x, float y, float window);
+
+        /**
+         * @brief First intersection of the lookahead circle with the path at or after the last one
+         *
+         * @return false if the circle does not reach the remaining path; targetX and targetY are left unchanged
+         */
+        bool lookahead(float x, float y, float radius, int closest, float& targetX, float& targetY);
+
+        // Start over from the beginning of the path
+        void reset();
+    private:
+        const Header* header;
+        const Waypoint* points;
+        int closestCursor = 0;
+        int lookaheadCursor = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,88 @@
+// profile.hpp
+//
+// Scoped execution time probes for the control loops. Build with `make
+// PROFILE=1` to enable them; otherwise the macros compile to nothing.
+//
+//     void update() {
+//         PROFILE_SCOPE("intake");
+//         ...
+//     }
+#include "api.h"
+
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+namespace robot::profile {
+    constexpr int MAX_REGIONS = 16;
+    // histogram buckets: 1 us wide up to 16 us, then 8 per power of two up to 2^24 us
+    constexpr int BUCKETS = 16 + 20 * 8;
+
+    /**
+     * Execution times of one named region, in microseconds.
+     *
+     * p99 comes from a histogram with buckets about 12% wide, so it is the upper edge of the bucket
+     * the 99th percentile falls in. A region should only be entered from one task at a time.
+     */
+    struct Region {
+        const char* name = nullptr;
+        uint32_t count = 0;
+        uint32_t min = UINT32_MAX;
+        uint32_t max = 0;
+        uint64_t total = 0;
+        uint32_t histogram[BUCKETS] = {};
+
+        void add(uint32_t us);
+        uint32_t mean() const;
+        uint32_t p99() const;
+        void reset();
+    };
+
+    // The region with this name, added on first use. nullptr once the table is full.
+    Region* region(const char* name);
+
+    // Regions in the order they were added
+    int regionCount();
+    Region& regionAt(int index);
+
+    // Print the table to the terminal
+    void print();
+
+    // Clear the numbers, keeping the regions
+    void reset();
+
+    // Times from construction until stop() or destruction into a region
+    class Probe {
+    public:
+        explicit Probe(Region* region)
+            : target(region),
+              start(pros::micros()) {}
+
+        ~Probe() { stop(); }
+
+        void stop() {
+            if (target == nullptr) return;
+            target->add(pros::micros() - start);
+            target = nullptr;
+        }
+
+        Probe(const Probe&) = delete;
+        Probe& operator=(const Probe&) = delete;
+    private:
+        Region* target;
+        uint64_t start;
+    };
+}
+
+#ifdef PROFILE
+// time the rest of the enclosing block as the named region
+#define PROFILE_SCOPE(name)                                                                                            \
+    static robot::profile::Region* const profileRegion = robot::profile::region(name);                                 \
+    robot::profile::Probe profileProbe(profileRegion)
+// end the enclosing PROFILE_SCOPE early, e.g. before the loop sleeps
+#define PROFILE_STOP() profileProbe.stop()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_STOP()
+#endif
+
+#endif
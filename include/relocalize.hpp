@@ -0,0 +1,81 @@
+// relocalize.hpp
+#include "api.h"
+#include "chassis.hpp"
+#include "odometry.hpp"
+#include <vector>
+
+#ifndef RELOCALIZE_HPP
+#define RELOCALIZE_HPP
+
+namespace robot {
+    // A distance sensor and where it sits on the robot, relative to the tracking centre
+    struct WallSensor {
+        pros::Distance* sensor;
+        float x; // in, to the right
+        float y; // in, forwards
+        float angle; // deg the sensor faces, clockwise from the front
+    };
+
+    // Which readings count as the field wall
+    struct RelocalizeSettings {
+        RelocalizeSettings(float wallDistance, float maxRange, float maxIncidence, float cornerMargin,
+                           float outlierGate, int minConfidence)
+            : wallDistance(wallDistance),
+              maxRange(maxRange),
+              maxIncidence(maxIncidence),
+              cornerMargin(cornerMargin),
+              outlierGate(outlierGate),
+              minConfidence(minConfidence) {}
+
+        float wallDistance; // in, from the field centre to each wall
+        float maxRange; // in
+        float maxIncidence; // deg the beam may be off square to the wall
+        float cornerMargin; // in, beams landing this close to a corner may hit either wall
+        float outlierGate; // in, a reading this much shorter or longer than expected is something else
+        int minConfidence; // 0 - 63, the sensor only rates readings past 200 mm
+    };
+
+    /**
+     * Corrects x and y from distance sensors facing the field walls.
+     *
+     * A sensor is used when, going by the current pose, its beam meets a wall nearly square on and away
+     * from the corners. The wall fixes the coordinate across it: x for the side walls, y for the ends.
+     * A reading too far from the distance the pose predicts is left out as a robot, goal or ring in the
+     * way, so this trims odometry drift but can't find the robot from scratch. With an Odometry filter
+     * the readings are fused as measurements, otherwise relocalize() sets the pose.
+     */
+    class Relocalizer {
+    public:
+        Relocalizer(std::vector<WallSensor> sensors, RelocalizeSettings settings, Chassis* chassis,
+                    Odometry* odometry = nullptr);
+
+        // Correct the pose from the walls the sensors see now. Returns the number of readings used.
+        int relocalize();
+
+        // Keep relocalizing every period milliseconds while enabled. Needs the Odometry filter.
+        void start(uint32_t period = 50);
+        void setEnabled(bool enabled);
+
+        // readings left out as something in the way of the wall
+        uint32_t getRejected();
+    private:
+        struct Reading {
+            bool xAxis; // corrects x (a side wall) or y (an end wall)
+            float value; // in, the corrected coordinate
+            float deviation; // in
+        };
+
+        // the reading of one sensor, false if it doesn't see a wall it can trust
+        bool read(const WallSensor& wall, const lemlib::Pose& pose, Reading& reading);
+
+        std::vector<WallSensor> sensors;
+        RelocalizeSettings settings;
+        Chassis* chassis;
+        Odometry* odometry;
+        bool enabled = true;
+        uint32_t rejected = 0;
+        pros::Mutex mutex;
+    };
+}
+
+#endif
@@ -0,0 +1,109 @@
+// ringsensor.hpp
+#include "api.h"
+#include <array>
+#include <vector>
+
+#ifndef RINGSENSOR_HPP
+#define RINGSENSOR_HPP
+
+namespace robot {
+    enum class RingColor {
+        NONE,
+        RED,
+        BLUE
+    };
+
+    // A ring the optical sensor picked up
+    struct RingDetection {
+        uint64_t time; // micros() of the sample
+        double travel; // intake travel when its leading edge reached the sensor, deg
+        RingColor color;
+    };
+
+    // What a ring color reads under the sensor's LED: each channel of get_rgb() over the sum of the three
+    struct RingCalibration {
+        RingColor color;
+        float red;
+        float green;
+        float blue;
+    };
+
+    // The range of get_hue() a ring color reads in, deg
+    struct HueWindow {
+        RingColor color;
+        float min;
+        float max;
+    };
+
+    // Which readings count as a ring
+    struct RingSensorSettings {
+        RingSensorSettings(int minProximity, float maxDistance, float ringLength)
+            : minProximity(minProximity),
+              maxDistance(maxDistance),
+              ringLength(ringLength) {}
+
+        int minProximity; // 0 - 255, higher is closer; anything further off is the empty intake
+        float maxDistance; // furthest a reading may be from a calibrated color (red, green, blue fractions) to be it
+        float ringLength; // deg of intake travel a ring stays in view; a longer unbroken reading is the next ring
+    };
+
+    /**
+     * Samples the optical sensor on its own task, faster than the control loops, and queues each ring it sees.
+     *
+     * Readings with the proximity below minProximity are the empty intake and aren't classified. The rest
+     * are classified by their red, green and blue fractions against the calibrated ring colors; the
+     * fractions don't change with how far off the ring is or how bright it reads. A detection is the first
+     * sample of a ring, stamped with the time and the intake's travel, halfway back to the previous sample.
+     * With no calibrated colors every reading is classified by the hue windows instead, as the color sort
+     * did before, proximity or not.
+     */
+    class RingSensor {
+    public:
+        /**
+         * @param reversed the intake takes rings in while running backwards
+         */
+        RingSensor(pros::Optical* optical, pros::Motor* intake, bool reversed, std::vector<RingCalibration> colors,
+                   std::vector<HueWindow> hues, RingSensorSettings settings);
+
+        // Sample every period milliseconds
+        void start(uint32_t period = 5);
+
+        // Take one sample; start() does this on its task
+        void sample();
+
+        // Take the oldest detection off the queue, false when it is empty
+        bool pop(RingDetection& detection);
+
+        // The calibrated color a reading is nearest, NONE if it is near none of them
+        RingColor classify(const pros::c::optical_rgb_s_t& rgb) const;
+
+        // The hue window a reading is in, NONE if none
+        RingColor classify(double hue) const;
+
+        uint32_t getSamples();
+        uint32_t getSkipped(); // samples with nothing in front of the sensor
+        uint32_t getDropped(); // detections lost to a full queue
+    private:
+        static constexpr size_t CAPACITY = 16;
+
+        pros::Optical* optical;
+        pros::Motor* intake;
+        double direction;
+        std::vector<RingCalibration> colors;
+        std::vector<HueWindow> hues;
+        RingSensorSettings settings;
+        std::array<RingDetection, CAPACITY> queue {};
+        size_t first = 0;
+        size_t count = 0;
+        RingColor seeing = RingColor::NONE; // at the last sample
+        double edge = 0; // travel at the leading edge of the ring in view
+        double lastTravel = 0;
+        bool started = false;
+        uint32_t samples = 0;
+        uint32_t skipped = 0;
+        uint32_t dropped = 0;
+        pros::Mutex mutex;
+    };
+}
+
+#endif
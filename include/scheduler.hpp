@@ -0,0 +1,83 @@
+// scheduler.hpp
+#include "api.h"
+#include "telemetry.hpp"
+#include <functional>
+#include <vector>
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+namespace robot {
+    /**
+     * Runs periodic jobs on fixed ticks from a single task.
+     *
+     * Ticks are spaced with Task::delay_until, so the period does not stretch with the work done in
+     * it. Each job has its own period (a multiple of the tick) and a priority; jobs due on the same
+     * tick run in priority order, highest first. Every start is measured against its scheduled time,
+     * and the period and jitter of each job are kept in histograms. A started scheduler logs them, with
+     * the totals so far, every reportPeriod and once more when it stops.
+     */
+    class Scheduler {
+    public:
+        // upper bucket edges in microseconds, the last bucket is everything above
+        static constexpr uint32_t BUCKET_EDGES[] = {100, 250, 500, 1000, 2000, 5000, 10000};
+        static constexpr int BUCKETS = sizeof(BUCKET_EDGES) / sizeof(BUCKET_EDGES[0]) + 1;
+
+        struct Stats {
+            uint32_t runs = 0;
+            uint32_t overruns = 0; // whole periods skipped because the job started too late
+            uint32_t periodHistogram[BUCKETS] = {}; // |start-to-start time - period|
+            uint32_t jitterHistogram[BUCKETS] = {}; // start time - scheduled start time
+            uint32_t maxJitter = 0; // us
+            uint32_t maxRuntime = 0; // us
+            uint64_t totalRuntime = 0; // us
+        };
+
+        // tick is the resolution of the job periods in milliseconds; reportPeriod is in milliseconds, 0 to only
+        // report when the scheduler stops
+        explicit Scheduler(uint32_t tick = 5, uint32_t reportPeriod = 10000);
+
+        /**
+         * @brief Register a job. Call before run/start.
+         *
+         * @param period milliseconds between runs, rounded up to a multiple of the tick
+         * @param priority jobs due on the same tick run highest priority first
+         */
+        void add(const char* name, uint32_t period, int priority, std::function<void()> job);
+
+        // Run the jobs in the calling task while condition() holds
+        void run(std::function<bool()> condition = [] { return true; });
+
+        // Run the jobs in a new task while condition() holds, logging the statistics to the terminal through
+        // telemetry::log() every reportPeriod and at the end. The scheduler must outlive the task.
+        void start(const char* name, std::function<bool()> condition = [] { return true; });
+
+        const Stats& stats(const char* name) const;
+    private:
+        struct Job {
+            const char* name;
+            uint16_t nameId; // telemetry::intern(name)
+            uint32_t period; // ms
+            int priority;
+            std::function<void()> function;
+            uint32_t nextRun = 0; // ms
+            uint64_t lastStart = NEVER; // us
+            Stats stats;
+        };
+
+        static constexpr uint64_t NEVER = UINT64_MAX;
+
+        static int bucket(uint32_t us);
+
+        // Push the per-job statistics into reports, from the task that ran the jobs
+        void report();
+
+        uint32_t tick;
+        uint32_t reportPeriod; // ms, 0 for none
+        bool reporting = false; // started, so the reports ring is drained
+        std::vector<Job> jobs;
+        telemetry::Ring<32> reports; // added to telemetry::log() by start()
+    };
+}
+
+#endif
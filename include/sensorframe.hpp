@@ -0,0 +1,68 @@
+// sensorframe.hpp
+#include "api.h"
+
+#ifndef SENSORFRAME_HPP
+#define SENSORFRAME_HPP
+
+namespace robot {
+    /**
+     * Everything the opcontrol handlers read, sampled once per tick.
+     *
+     * Every handler sees the same readings for the tick, and each device is read once no matter how
+     * many handlers look at it. Button edges are worked out against the previous frame.
+     */
+    class SensorFrame {
+    public:
+        struct Counters {
+            uint32_t frames = 0;
+            uint32_t reads = 0; // device reads made while sampling
+            uint32_t handlerReads = 0; // values handed to the handlers, each a device read they used to make
+
+            int32_t saved() const { return int32_t(handlerReads - reads); }
+        };
+
+        // Read every device. Call once at the start of a tick.
+        void sample();
+
+        uint64_t time() const { return sampledAt; } // micros() when sampled
+
+        // Controller
+        int analog(pros::controller_analog_e_t channel) const;
+        bool held(pros::controller_digital_e_t button) const;
+        bool pressed(pros::controller_digital_e_t button) const; // went down since the last frame
+
+        // Mechanism sensors
+        double intakePosition() const;
+        double lbPosition() const;
+        double lbVelocity() const;
+
+        static const Counters& counters() { return totals; }
+    private:
+        uint32_t bit(pros::controller_digital_e_t button) const;
+
+        // count a device read while sampling
+        template <typename T> static T read(T value) {
+            totals.reads++;
+            return value;
+        }
+
+        // count a value handed to a handler
+        template <typename T> static T handOut(T value) {
+            totals.handlerReads++;
+            return value;
+        }
+
+        uint64_t sampledAt = 0;
+        int leftY = 0;
+        int rightX = 0;
+        uint32_t buttons = 0; // one bit per button, see bit()
+        uint32_t newPresses = 0;
+        double intakePositionValue = 0;
+        double lbPositionValue = 0;
+        double lbVelocityValue = 0;
+
+        static Counters totals;
+    };
+}
+
+#endif
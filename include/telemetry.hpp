@@ -0,0 +1,178 @@
+// telemetry.hpp
+#include "api.h"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+namespace robot::telemetry {
+    constexpr int MAX_FIELDS = 14;
+
+    // One logged sample, written and read as raw bytes
+    struct Record {
+        uint32_t time; // us
+        uint16_t type; // chosen by the producer, tells the reader what the fields are
+        uint16_t count; // fields used
+        float fields[MAX_FIELDS];
+    };
+
+    static_assert(sizeof(Record) == 64, "records are stored and written as raw bytes");
+
+    // Record types the robot logs, and their fields
+    enum Type : uint16_t {
+        FLIGHT = 1, // FlightLog::Sample without the time, which is the record's in ms
+        JOB = 2, // name, period ms, runs, overruns, max jitter us, mean runtime us (Scheduler::Stats)
+        JOB_JITTER = 3, // name, then the jitter histogram
+        JOB_PERIOD = 4, // name, then the period histogram
+        JAM = 5, // port, ms jammed, reverses, outcome (JamDetector)
+        MAX_TYPES = 16
+    };
+
+    /**
+     * Fixed capacity single producer, single consumer queue of records.
+     *
+     * Pushing never blocks, allocates or takes a lock: a full ring drops the record and counts it.
+     * Exactly one task may push and exactly one (the drainer) may pop. Give each producing task its
+     * own ring.
+     */
+    class RingBase {
+    public:
+        // Producer side. Returns false and counts a drop if the ring is full.
+        bool push(const Record& record) {
+            const uint32_t head = this->head.load(std::memory_order_relaxed);
+            if (head - tail.load(std::memory_order_acquire) > mask) {
+                drops.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            slots[head & mask] = record;
+            this->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Stamp the current time and push, fields past MAX_FIELDS are ignored
+        bool push(uint16_t type, std::initializer_list<float> fields) {
+            Record record = {uint32_t(pros::micros()), type, 0, {}};
+            for (float field : fields) {
+                if (record.count == MAX_FIELDS) break;
+                record.fields[record.count++] = field;
+            }
+            return push(record);
+        }
+
+        // Consumer side. Returns false if the ring is empty.
+        bool pop(Record& record) {
+            const uint32_t tail = this->tail.load(std::memory_order_relaxed);
+            if (tail == head.load(std::memory_order_acquire)) return false;
+            record = slots[tail & mask];
+            this->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+        uint32_t capacity() const { return mask + 1; }
+
+        uint32_t dropped() const { return drops.load(std::memory_order_relaxed); }
+    protected:
+        RingBase(Record* slots, uint32_t capacity)
+            : slots(slots),
+              mask(capacity - 1) {}
+    private:
+        Record* slots;
+        uint32_t mask;
+        // free running counters, the slot is the counter masked
+        std::atomic<uint32_t> head = 0;
+        std::atomic<uint32_t> tail = 0;
+        std::atomic<uint32_t> drops = 0;
+    };
+
+    template <uint32_t N> class Ring : public RingBase {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "ring capacity must be a power of two");
+    public:
+        Ring()
+            : RingBase(storage, N) {}
+
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+    private:
+        Record storage[N];
+    };
+
+    /**
+     * Empties a set of rings into a sink from a background task.
+     *
+     * The rings are visited in turn so a busy producer cannot starve the others. All serialization
+     * happens here, off the control tasks.
+     */
+    class Drainer {
+    public:
+        static constexpr int MAX_RINGS = 8;
+
+        explicit Drainer(std::function<void(const Record&)> sink);
+
+        // Add a ring to drain, also while the drainer runs, from one task at a time. Returns false if there is
+        // no room.
+        bool add(RingBase& ring);
+
+        // Pop up to limit records, returns how many were written to the sink
+        uint32_t drain(uint32_t limit = UINT32_MAX);
+
+        // Drain every period milliseconds in a new low priority task. The drainer must outlive the task.
+        void start(uint32_t period = 10) {
+            pros::Task(
+                [this, period] {
+                    uint32_t now = pros::millis();
+                    while (true) {
+                        drain();
+                        pros::Task::delay_until(&now, period);
+                    }
+                },
+                TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT, "Telemetry");
+        }
+
+        uint32_t written() const { return count; }
+
+        // records dropped by all the rings because they were full
+        uint32_t dropped() const;
+    private:
+        std::function<void(const Record&)> sink;
+        RingBase* rings[MAX_RINGS] = {};
+        std::atomic<int> ringCount = 0;
+        int next = 0;
+        uint32_t count = 0;
+    };
+
+    // Prints one record as a text line, see setFormatter
+    using Formatter = void (*)(const Record& record, FILE* file);
+
+    // Have printText print records of this type with formatter
+    void setFormatter(uint16_t type, Formatter formatter);
+
+    // Sink that prints records with their type's formatter, or as "type,time,field,..." lines
+    void printText(const Record& record, FILE* file = stdout);
+
+    /**
+     * A number that stands for a string in a record field (exactly, as a float), such as a job name.
+     * The same pointer always gets the same number, so pass string literals. Returns 0 once the table
+     * of MAX_NAMES is full.
+     */
+    constexpr int MAX_NAMES = 64;
+    uint16_t intern(const char* text);
+
+    // The string behind a number from intern(), "?" for an unknown one
+    const char* lookup(float id);
+
+    /**
+     * The robot's drainer: rings added to it are printed to the terminal with printText, off the
+     * tasks that filled them. initialize() starts it.
+     */
+    Drainer& log();
+
+    // Sink that writes the raw records, e.g. to a file on the SD card
+    void writeBinary(const Record& record, FILE* file);
+}
+
+#endif
@@ -0,0 +1,164 @@
+// jambench: how quickly the JamDetector gets a jammed intake running again,
+// and that it leaves a healthy one alone.
+//
+//     ./bin/jambench
+//
+// A jam is injected as a hard stop at some point of the intake's travel: the
+// hooks stall against it, drawing stall current, until they have been backed
+// off by the jam's clearance (the ring reseats), after which the stop is gone.
+// The intake runs at full speed as autonomous runs it, every 10 ms, with its
+// command passed through the detector.
+//
+// "healthy" starts, stops (as the color sort's ejects do) and turns the intake
+// around for 20 s with nothing in the way; every jam it reports is a false
+// one. "jams" injects JAMS jams a random distance apart, most cleared by one
+// reverse and some needing two; "lost" is from the hooks hitting the jam to
+// them getting past it. Without the detector the intake stays stalled on the
+// first jam. "stuck" is a jam that never clears, which the detector has to
+// give up on.
+#include "main.h"
+#include "config.hpp"
+#include "sim/kernel.hpp"
+#include "sim/model.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+// src/config.cpp
+constexpr int INTAKE_PORT = 9;
+constexpr double INTAKE_SPEED = 600; // rpm
+
+constexpr std::uint32_t TICK = 10; // ms
+constexpr int JAMS = 30;
+constexpr std::uint32_t TIMEOUT = 60000; // ms to get past all the jams
+
+struct Jam {
+        double at; // intake travel, deg
+        double clearance; // deg to back off, infinite for one that never clears
+        double hit = -1; // s, when the hooks stalled on it
+        double passed = -1; // s, when they got past it
+};
+
+double travel() { return -sim::world().motor(INTAKE_PORT).position; }
+
+// one control tick: the command through the detector, as autonomous does it
+void drive(double command, bool detect) {
+    if (detect) command = robot::mechanisms::intakeJam.update(command);
+    robot::mechanisms::intakeMotor.move_velocity(command);
+    pros::delay(TICK);
+}
+
+void settle() {
+    robot::mechanisms::intakeJam.update(0);
+    robot::mechanisms::intakeMotor.move_velocity(0);
+    pros::delay(500);
+}
+
+void healthy() {
+    const std::uint32_t before = robot::mechanisms::intakeJam.counters().jams;
+    const std::uint32_t start = pros::millis();
+    while (pros::millis() - start < 20000) {
+        const std::uint32_t t = pros::millis() - start;
+        // a 200 ms eject every 600 ms, turning around every 5 s
+        const double direction = (t / 5000) % 2 == 0 ? -1 : 1;
+        drive(t % 600 < 200 ? 0 : direction * INTAKE_SPEED, true);
+    }
+    settle();
+    std::printf("healthy: %u false jams in 20 s of starts, ejects and turnarounds\n",
+                (unsigned)(robot::mechanisms::intakeJam.counters().jams - before));
+}
+
+// runs the intake through the jams, false if it did not get past them all
+bool run(std::vector<Jam>& jams, bool detect, std::uint32_t timeout = TIMEOUT) {
+    sim::World& world = sim::world();
+    std::size_t next = 0;
+    bool active = false;
+    world.afterStep = [&]() {
+        if (next == jams.size()) return;
+        Jam& jam = jams[next];
+        const double position = travel();
+        if (!active && jam.hit < 0 && position >= jam.at) {
+            world.motor(INTAKE_PORT).minPosition = -jam.at;
+            jam.hit = world.time;
+            active = true;
+        } else if (active && position <= jam.at - jam.clearance) {
+            world.motor(INTAKE_PORT).minPosition = -INFINITY;
+            active = false;
+        } else if (!active && jam.hit >= 0 && position > jam.at) {
+            jam.passed = world.time;
+            next++;
+        }
+    };
+    const std::uint32_t start = pros::millis();
+    while (next < jams.size() && pros::millis() - start < timeout) drive(-INTAKE_SPEED, detect);
+    // long enough for the detector to see it get past the last one too
+    for (int i = 0; i < 10; i++) drive(-INTAKE_SPEED, detect);
+    world.afterStep = nullptr;
+    world.motor(INTAKE_PORT).minPosition = -INFINITY;
+    settle();
+    return next == jams.size();
+}
+
+std::vector<Jam> injected() {
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> spacing(1000, 3000);
+    std::uniform_real_distribution<double> clearance(30, 250);
+    std::vector<Jam> jams;
+    double at = travel();
+    for (int i = 0; i < JAMS; i++) {
+        at += spacing(random);
+        // every fifth one holds on past the first reverse
+        jams.push_back({at, i % 5 == 4 ? 500 : clearance(random)});
+    }
+    return jams;
+}
+
+void jams() {
+    const robot::JamDetector::Counters before = robot::mechanisms::intakeJam.counters();
+    std::vector<Jam> jams = injected();
+    const bool finished = run(jams, true);
+    const robot::JamDetector::Counters& after = robot::mechanisms::intakeJam.counters();
+    double total = 0;
+    double worst = 0;
+    for (const Jam& jam : jams) {
+        if (jam.passed < 0) continue;
+        total += jam.passed - jam.hit;
+        worst = std::max(worst, jam.passed - jam.hit);
+    }
+    std::printf("jams: %d injected, %u found, %u cleared, %u reverses, %s\n", JAMS, (unsigned)(after.jams - before.jams),
+                (unsigned)(after.cleared - before.cleared), (unsigned)(after.reverses - before.reverses),
+                finished ? "all passed" : "stuck");
+    std::printf("      lost %.0f ms a jam on average, %.0f ms at most\n", total / JAMS * 1000, worst * 1000);
+
+    std::vector<Jam> undetected = injected();
+    const bool passed = run(undetected, false);
+    std::printf("without the detector: %s\n", passed ? "all passed" : "stalled on the first jam until the timeout");
+}
+
+void stuck() {
+    const robot::JamDetector::Counters before = robot::mechanisms::intakeJam.counters();
+    std::vector<Jam> jams = {{travel() + 1000, INFINITY}};
+    run(jams, true, 5000);
+    const robot::JamDetector::Counters& after = robot::mechanisms::intakeJam.counters();
+    std::printf("stuck: %u reverses, then left stalled (%u jam, %u cleared)\n",
+                (unsigned)(after.reverses - before.reverses), (unsigned)(after.jams - before.jams),
+                (unsigned)(after.cleared - before.cleared));
+}
+} // namespace
+
+int main() {
+    sim::attachModel();
+    const bool finished = sim::run(
+        []() {
+            initialize();
+            healthy();
+            jams();
+            stuck();
+        },
+        600000);
+    return finished ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// lbbench: how long the LB takes to get to its positions, the velocity loop it
+// used to run against robot::ArmController.
+//
+//     ./bin/lbbench
+//
+// Runs the LB through the moves the routines and the driver toggle make, one
+// after the other, on the simulator's arm: 12 V turns it at 100 rpm and
+// gravity takes up to 25 rpm off that, pulling it back down whenever it is off
+// vertical. The old loop is reimplemented here as autonomous ran it: a
+// velocity command of 0.01 rpm per centidegree of error, at most 100 rpm,
+// done once within 200 centidegrees. Both are updated every 10 ms, as the
+// autonomous runtime does, with its brake modes.
+//
+// "done" is when the controller says it is done, "settled" when the arm got
+// within 100 centidegrees of the target and under 2000 centidegrees/s for good
+// (the ArmController's tolerances), "over" how far it went past the target and
+// "sag" how far off it is 2 s after the move started. The ArmController is done
+// 40-50 ms after the arm settles: it sees the arm a tick late, its velocity is
+// filtered from the sensor and takes another tick or so to drop under the
+// tolerance, and it then waits out its 20 ms settle time. Moves to the rest
+// position 0 are done on arrival instead. The velocity loop is done as soon as
+// it is within 200 centidegrees, still moving, and settles after that.
+#include "main.h"
+#include "config.hpp"
+#include "sim/kernel.hpp"
+#include "sim/model.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+// src/config.cpp
+constexpr int LB_PORT = 10;
+
+constexpr std::uint32_t TICK = 10; // ms
+constexpr std::uint32_t WINDOW = 2000; // ms each move gets
+constexpr double TOLERANCE = 100; // centidegrees
+constexpr double VELOCITY_TOLERANCE = 2000; // centidegrees/s
+
+// autonomous: stake, descore and back down, then the driver toggle
+constexpr double TARGETS[] = {4800, 8000, 18000, 11000, 0, 25000, 0, 4200, 6000, 0};
+
+struct Result {
+        std::uint32_t done = WINDOW; // ms
+        std::uint32_t settled = 0; // ms
+        double overshoot = 0; // centidegrees
+        double sag = 0; // centidegrees
+};
+
+// where the arm really is, without the sensor resets
+double position() { return sim::world().motor(LB_PORT).position * 100; }
+
+// the P-only velocity loop autonomous ran before
+class VelocityLoop {
+    public:
+        void moveTo(double target) {
+            this->target = target;
+            moving = true;
+        }
+
+        void update() {
+            if (!moving) return;
+            const double error = target - robot::mechanisms::lbRotationSensor.get_position();
+            if (std::abs(error) < 200) {
+                moving = false;
+                robot::mechanisms::lbMotor.move_velocity(0);
+                return;
+            }
+            robot::mechanisms::lbMotor.move_velocity(std::clamp(0.01 * error, -100.0, 100.0));
+        }
+
+        void stop() { moving = false; }
+
+        bool isMoving() const { return moving; }
+    private:
+        double target = 0;
+        bool moving = false;
+};
+
+template <typename Controller> Result move(Controller& controller, double target) {
+    const double direction = target >= position() ? 1 : -1;
+    Result result;
+    bool done = false;
+    controller.moveTo(target);
+    for (std::uint32_t t = 0; t < WINDOW; t += TICK) {
+        controller.update();
+        robot::mechanisms::lbMotor.set_brake_mode(robot::mechanisms::lbRotationSensor.get_position() <= 200
+                                                      ? pros::E_MOTOR_BRAKE_COAST
+                                                      : pros::E_MOTOR_BRAKE_HOLD);
+        if (!done && !controller.isMoving()) {
+            done = true;
+            result.done = t;
+        }
+        const double before = position();
+        pros::delay(TICK);
+        const double error = target - position();
+        const double velocity = (position() - before) * 1000 / TICK;
+        if (std::abs(error) >= TOLERANCE || std::abs(velocity) >= VELOCITY_TOLERANCE) result.settled = t + TICK;
+        result.overshoot = std::max(result.overshoot, -direction * error);
+    }
+    controller.stop();
+    result.sag = std::abs(target - position());
+    return result;
+}
+
+template <typename Controller> void run(const char* name, Controller& controller) {
+    std::printf("%s\n", name);
+    std::printf("%6s %6s %6s %8s %6s %6s\n", "from", "to", "done", "settled", "over", "sag");
+    std::printf("%6s %6s %6s %8s %6s %6s\n", "(cdeg)", "(cdeg)", "(ms)", "(ms)", "(cdeg)", "(cdeg)");
+    double from = 0;
+    std::uint32_t done = 0;
+    std::uint32_t settled = 0;
+    for (double target : TARGETS) {
+        const Result result = move(controller, target);
+        std::printf("%6.0f %6.0f %6u %8u %6.0f %6.0f\n", from, target, (unsigned)result.done,
+                    (unsigned)result.settled, result.overshoot, result.sag);
+        done += result.done;
+        settled += result.settled;
+        from = target;
+    }
+    std::printf("total: %u ms to done, %u ms to settled\n\n", (unsigned)done, (unsigned)settled);
+}
+} // namespace
+
+int main() {
+    sim::attachModel();
+    const bool finished = sim::run(
+        []() {
+            initialize();
+            VelocityLoop velocityLoop;
+            run("velocity loop (kP 0.01 rpm/cdeg, 100 rpm, done within 200)", velocityLoop);
+            run("ArmController", robot::mechanisms::lbController);
+        },
+        600000);
+    return finished ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// pathbench: per-cycle CPU cost of the pure pursuit queries in Chassis::follow.
+//
+//     ./bin/pathbench bin/obj/paths/static/Skill1.path ...
+//
+// Drives a point along each compiled path (0.6 in per 10 ms cycle, weaving
+// 1.5 in either side of it) and times the closest point and lookahead searches
+// two ways: scanning every waypoint each cycle, as LemLib does, and through
+// robot::path::PathView. "differ" counts the cycles where the two picked a
+// different closest point; that happens where a path crosses or doubles back
+// on itself and the full scan jumps to another part of it.
+#include "path.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+constexpr float LOOKAHEAD = 10;
+constexpr float STEP = 0.6; // in per cycle
+constexpr int REPEATS = 200;
+
+struct Point {
+        float x;
+        float y;
+};
+
+// positions of the robot along the path, one per control cycle, up to where follow() stops
+std::vector<Point> trajectory(robot::path::PathView& path) {
+    std::vector<Point> points;
+    float end = path.length();
+    for (int i = 0; i < path.size(); i++) {
+        if (path[i].speed == 0) {
+            end = path[i].distance;
+            break;
+        }
+    }
+    int segment = 0;
+    for (float s = 0; s < end - LOOKAHEAD / 2; s += STEP) {
+        while (segment < path.size() - 2 && path[segment + 1].distance < s) segment++;
+        const robot::path::Waypoint& a = path[segment];
+        const robot::path::Waypoint& b = path[segment + 1];
+        const float span = b.distance - a.distance;
+        if (span == 0) continue;
+        const float t = (s - a.distance) / span;
+        const float offset = 1.5 * std::sin(s / 10);
+        const float nx = -(b.y - a.y) / span;
+        const float ny = (b.x - a.x) / span;
+        points.push_back({a.x + (b.x - a.x) * t + nx * offset, a.y + (b.y - a.y) * t + ny * offset});
+    }
+    return points;
+}
+
+// LemLib's search: closest point over the whole path, then the first lookahead intersection after it
+struct LinearSearch {
+        const robot::path::PathView& path;
+        int lastLookahead = 0;
+
+        int closest(float x, float y) {
+            int best = 0;
+            float bestDist = INFINITY;
+            for (int i = 0; i < path.size(); i++) {
+                const float dist = std::hypot(path[i].x - x, path[i].y - y);
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        bool lookahead(float x, float y, int closest, float& targetX, float& targetY) {
+            for (int i = std::max(closest, lastLookahead); i < path.size() - 1; i++) {
+                const robot::path::Waypoint& p1 = path[i];
+                const robot::path::Waypoint& p2 = path[i + 1];
+                const float dx = p2.x - p1.x, dy = p2.y - p1.y, fx = p1.x - x, fy = p1.y - y;
+                const float a = dx * dx + dy * dy;
+                if (a == 0) continue;
+                const float b = 2 * (fx * dx + fy * dy);
+                const float c = fx * fx + fy * fy - LOOKAHEAD * LOOKAHEAD;
+                float discriminant = b * b - 4 * a * c;
+                if (discriminant < 0) continue;
+                discriminant = std::sqrt(discriminant);
+                float t = (-b + discriminant) / (2 * a);
+                if (t < 0 || t > 1) t = (-b - discriminant) / (2 * a);
+                if (t < 0 || t > 1) continue;
+                targetX = p1.x + dx * t;
+                targetY = p1.y + dy * t;
+                lastLookahead = i;
+                return true;
+            }
+            return false;
+        }
+};
+
+struct ViewSearch {
+        robot::path::PathView view;
+
+        int closest(float x, float y) { return view.closest(x, y, LOOKAHEAD); }
+
+        bool lookahead(float x, float y, int closest, float& targetX, float& targetY) {
+            return view.lookahead(x, y, LOOKAHEAD, closest, targetX, targetY);
+        }
+};
+
+// closest point picked in each cycle
+template <typename Search> std::vector<int> run(const std::vector<Point>& cycles, Search search) {
+    std::vector<int> picked;
+    float targetX = 0, targetY = 0;
+    for (const Point& point : cycles) {
+        picked.push_back(search.closest(point.x, point.y));
+        search.lookahead(point.x, point.y, picked.back(), targetX, targetY);
+    }
+    return picked;
+}
+
+// ns per cycle
+template <typename Search> double timeCycles(const std::vector<Point>& cycles, const Search& prototype) {
+    volatile float sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        Search search = prototype;
+        float targetX = 0, targetY = 0;
+        for (const Point& point : cycles) {
+            const int closest = search.closest(point.x, point.y);
+            search.lookahead(point.x, point.y, closest, targetX, targetY);
+            sink = sink + targetX + targetY;
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / REPEATS / cycles.size();
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::printf("%-24s %6s %8s %7s %10s %10s %8s %7s\n", "path", "points", "length", "cycles", "linear ns", "view ns",
+                "speedup", "differ");
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const asset path = {data.data(), data.size()};
+        if (!robot::path::isCompiled(path)) {
+            std::fprintf(stderr, "%s: not a compiled path\n", argv[i]);
+            status = 1;
+            continue;
+        }
+        robot::path::PathView view(path);
+        const std::vector<Point> cycles = trajectory(view);
+        const LinearSearch linear {view};
+        const ViewSearch cursor {robot::path::PathView(path)};
+
+        const std::vector<int> linearPicks = run(cycles, linear);
+        const std::vector<int> cursorPicks = run(cycles, cursor);
+        int differ = 0;
+        for (std::size_t cycle = 0; cycle < cycles.size(); cycle++) differ += linearPicks[cycle] != cursorPicks[cycle];
+
+        const double linearTime = timeCycles(cycles, linear);
+        const double cursorTime = timeCycles(cycles, cursor);
+        const char* name = std::strrchr(argv[i], '/') != nullptr ? std::strrchr(argv[i], '/') + 1 : argv[i];
+        std::printf("%-24s %6d %8.1f %7zu %10.0f %10.0f %7.1fx %7d\n", name, view.size(), view.length(),
+                    cycles.size(), linearTime, cursorTime, linearTime / cursorTime, differ);
+    }
+    return status;
+}
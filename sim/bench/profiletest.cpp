@@ -0,0 +1,63 @@
+// profiletest: SCurve stays finite and lands on its distance for any start and
+// end velocity, short moves included.
+//
+//     ./bin/profiletest
+//
+// Sweeps distances from 0.05 in up (most of the cases shorter than it takes
+// to change speed), start velocities up to and past the limit, and end
+// velocities that are often out of reach, under the drive's and the LB's
+// limits. Each profile is sampled over its duration: position and velocity
+// must be finite, the velocity not negative, the position within the distance,
+// and the end state on the distance at the end velocity the profile settled
+// on. `make bench` runs it first; it exits 1 on any failure.
+#include "motionprofile.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+// src/config.cpp: driveProfile, and the LB in centidegrees
+constexpr robot::ProfileLimits DRIVE = {72, 300, 4000};
+constexpr robot::ProfileLimits LB = {45000, 300000, 300000 / 0.02f};
+
+constexpr int SAMPLES = 200;
+
+bool check(float distance, float start, float end, robot::ProfileLimits limits) {
+    const robot::SCurve profile(distance, start, end, limits);
+    const float total = profile.duration();
+    if (!std::isfinite(total) || total < 0) return false;
+    // float error relative to the move
+    const float slack = 1e-3f * std::max(distance, limits.velocity * 0.01f);
+    for (int i = 0; i <= SAMPLES; i++) {
+        const robot::SCurve::State state = profile.at(total * i / SAMPLES);
+        if (!std::isfinite(state.position) || !std::isfinite(state.velocity)) return false;
+        if (state.velocity < -slack || state.position < -slack || state.position > distance + slack) return false;
+    }
+    const robot::SCurve::State last = profile.at(total);
+    return std::fabs(last.position - distance) <= slack &&
+           std::fabs(last.velocity - profile.endVelocity()) <= slack;
+}
+
+int sweep(const char* name, robot::ProfileLimits limits, float scale) {
+    int cases = 0;
+    int failures = 0;
+    for (float distance = 0.05f * scale; distance <= 120 * scale; distance *= 1.07f) {
+        for (float start = 0; start <= 75 * scale; start += 2.5f * scale) {
+            for (float end = 0; end <= 70 * scale; end += 2.5f * scale) {
+                cases++;
+                if (check(distance, start, end, limits)) continue;
+                if (failures++ < 10) {
+                    std::printf("  %s: distance %g, start %g, end %g\n", name, distance, start, end);
+                }
+            }
+        }
+    }
+    std::printf("%s: %d of %d profiles bad\n", name, failures, cases);
+    return failures;
+}
+} // namespace
+
+int main() {
+    // the LB moves 625 times the drive's numbers: 45000 centidegrees/s against 72 in/s
+    const int failures = sweep("drive", DRIVE, 1) + sweep("lb", LB, 625);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+// sortbench: how quickly rings are detected, and how many per second the color
+// sort gets through without a mis-eject.
+//
+//     ./bin/sortbench
+//
+// Feeds a stream of red and blue rings, in random order, up the simulated
+// intake. Rings ride the hooks a fixed spacing apart, measured in degrees of
+// intake travel from one ring's leading edge to the next, and are in front of
+// the optical sensor for a stretch of that.
+//
+// Detection runs the intake at full speed past a RingSensor sampling every
+// 5 ms and one sampling every 25 ms, as the opcontrol loop used to read the
+// hue: latency is from a ring's leading edge reaching the sensor to its
+// detection. The second case has each ring in view for less than a 25 ms tick,
+// as a ring passing the sensor edge-on is.
+//
+// Sorting has the color sort throw out blue. A ring goes over the top at TOP
+// degrees past the sensor and is thrown off if the hooks are stopped (under a
+// third of their speed) while it is within WINDOW of it, otherwise it is
+// scored. A mis-eject is a red ring thrown or a blue one scored. Runs at the
+// autonomous (10 ms) and driver control (25 ms) loop rates.
+#include "main.h"
+#include "config.hpp"
+#include "sim/kernel.hpp"
+#include "sim/model.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+// src/config.cpp
+constexpr int INTAKE_PORT = 9;
+constexpr double INTAKE_SPEED = 600; // rpm
+
+// the ring model, in degrees of intake travel
+constexpr double RING_LENGTH = 250; // in view of the sensor
+constexpr double EDGE_ON = 70; // in view when it passes edge-on
+constexpr double TOP = 620; // from the sensor to where the ring leaves the hooks
+constexpr double WINDOW = 90;
+constexpr double STOPPED = INTAKE_SPEED / 3; // rpm
+
+constexpr int RINGS = 60;
+constexpr std::uint32_t TIMEOUT = 60000; // ms
+
+enum class Fate { ON_HOOKS, THROWN, SCORED };
+
+struct Ring {
+        double entry; // travel at which its leading edge reaches the sensor
+        robot::RingColor color;
+        Fate fate = Fate::ON_HOOKS;
+        double seenAt = -1; // s, when its leading edge reached the sensor
+};
+
+// red, green and blue over their sum of the simulated rings (sim Optical::get_rgb)
+const std::vector<robot::RingCalibration> COLORS = {
+    {robot::RingColor::RED, 0.652, 0.217, 0.130},
+    {robot::RingColor::BLUE, 0.111, 0.333, 0.556},
+};
+
+struct Result {
+        double rate = 0; // rings per second
+        int thrown = 0;
+        int misEjects = 0;
+};
+
+double travel() { return -sim::world().motor(INTAKE_PORT).position; }
+
+// the same order of colors for every case
+std::vector<Ring> feed(double spacing) {
+    std::mt19937 random(7);
+    std::vector<Ring> rings;
+    for (int i = 0; i < RINGS; i++) {
+        const robot::RingColor color = random() % 2 == 0 ? robot::RingColor::RED : robot::RingColor::BLUE;
+        rings.push_back({travel() + 200 + i * spacing, color});
+    }
+    return rings;
+}
+
+// what the optical sensor sees: the ring in view, or the empty intake
+void show(const Ring* ring) {
+    sim::World& world = sim::world();
+    world.hue = ring == nullptr ? 60 : ring->color == robot::RingColor::RED ? 10 : 210;
+    world.saturation = ring == nullptr ? 0.1 : 0.8;
+    world.brightness = ring == nullptr ? 0.2 : 0.6;
+    world.proximity = ring == nullptr ? 20 : 200;
+}
+
+void detect(robot::RingSensor& fast, robot::RingSensor& slow, double inView) {
+    sim::World& world = sim::world();
+    std::vector<Ring> rings = feed(400);
+    world.afterStep = [&]() {
+        const double position = travel();
+        const Ring* visible = nullptr;
+        for (Ring& ring : rings) {
+            const double past = position - ring.entry;
+            if (past >= 0 && ring.seenAt < 0) ring.seenAt = world.time;
+            if (past >= 0 && past < inView) visible = &ring;
+        }
+        show(visible);
+    };
+    robot::RingDetection detection;
+    while (fast.pop(detection) || slow.pop(detection)) {}
+    std::vector<robot::RingDetection> fastDetections;
+    std::vector<robot::RingDetection> slowDetections;
+    robot::mechanisms::intakeMotor.move_velocity(-INTAKE_SPEED);
+    while (travel() < rings.back().entry + RING_LENGTH) {
+        while (fast.pop(detection)) fastDetections.push_back(detection);
+        while (slow.pop(detection)) slowDetections.push_back(detection);
+        pros::delay(10);
+    }
+    robot::mechanisms::intakeMotor.move_velocity(0);
+    pros::delay(500);
+    world.afterStep = nullptr;
+    show(nullptr);
+    while (fast.pop(detection)) fastDetections.push_back(detection);
+    while (slow.pop(detection)) slowDetections.push_back(detection);
+
+    for (auto [detections, period] : {std::pair {&fastDetections, 5}, std::pair {&slowDetections, 25}}) {
+        int found = 0;
+        int wrong = 0;
+        double total = 0;
+        double worst = 0;
+        std::vector<bool> matched(rings.size());
+        for (const robot::RingDetection& detection : *detections) {
+            // the ring whose leading edge is nearest the detection's
+            std::size_t nearest = 0;
+            for (std::size_t i = 1; i < rings.size(); i++) {
+                if (std::abs(rings[i].entry - detection.travel) < std::abs(rings[nearest].entry - detection.travel)) {
+                    nearest = i;
+                }
+            }
+            const Ring& ring = rings[nearest];
+            if (matched[nearest] || ring.color != detection.color) {
+                wrong++;
+                continue;
+            }
+            matched[nearest] = true;
+            found++;
+            const double latency = detection.time / 1000.0 - ring.seenAt * 1000;
+            total += latency;
+            worst = std::max(worst, latency);
+        }
+        std::printf("%6d %8.0f %7d %7d %7d %10.1f %9.1f\n", period, inView, RINGS - found, wrong, found,
+                    found > 0 ? total / found : 0.0, worst);
+    }
+}
+
+Result run(std::uint32_t period, double spacing) {
+    sim::World& world = sim::world();
+    world.motor(INTAKE_PORT).velocity = 0;
+    robot::mechanisms::colorSort.clear();
+    robot::mechanisms::colorSort.setRejected(robot::RingColor::BLUE);
+
+    std::vector<Ring> rings = feed(spacing);
+    int left = RINGS;
+    world.afterStep = [&]() {
+        const double position = travel();
+        const bool stopped = std::abs(world.motor(INTAKE_PORT).velocity) < STOPPED;
+        const Ring* visible = nullptr;
+        for (Ring& ring : rings) {
+            if (ring.fate != Fate::ON_HOOKS) continue;
+            const double past = position - ring.entry;
+            if (past >= 0 && past < RING_LENGTH) visible = &ring;
+            if (stopped && std::abs(past - TOP) <= WINDOW) ring.fate = Fate::THROWN;
+            else if (past > TOP + WINDOW) ring.fate = Fate::SCORED;
+            if (ring.fate != Fate::ON_HOOKS) left--;
+        }
+        show(visible);
+    };
+
+    std::uint32_t first = 0;
+    const std::uint32_t start = pros::millis();
+    while (left > 0 && pros::millis() - start < TIMEOUT) {
+        const bool ejecting = robot::mechanisms::colorSort.update(-robot::mechanisms::intakeMotor.get_position());
+        robot::mechanisms::intakeMotor.move_velocity(ejecting ? 0 : -INTAKE_SPEED);
+        if (first == 0 && travel() >= rings.front().entry) first = pros::millis();
+        pros::delay(period);
+    }
+    const std::uint32_t end = pros::millis();
+    robot::mechanisms::intakeMotor.move_velocity(0);
+    pros::delay(500);
+    world.afterStep = nullptr;
+    show(nullptr);
+
+    Result result;
+    result.rate = left > 0 || end == first ? 0 : RINGS * 1000.0 / (end - first);
+    for (const Ring& ring : rings) {
+        const bool blue = ring.color == robot::RingColor::BLUE;
+        result.thrown += ring.fate == Fate::THROWN;
+        result.misEjects += (ring.fate == Fate::THROWN) != blue || ring.fate == Fate::ON_HOOKS;
+    }
+    return result;
+}
+} // namespace
+
+int main() {
+    sim::attachModel();
+    const bool finished = sim::run(
+        []() {
+            initialize();
+            const robot::RingSensorSettings settings(100, 0.15, RING_LENGTH);
+            static robot::RingSensor fast(&robot::mechanisms::opticalSensor, &robot::mechanisms::intakeMotor, true,
+                                          COLORS, {}, settings);
+            static robot::RingSensor slow(&robot::mechanisms::opticalSensor, &robot::mechanisms::intakeMotor, true,
+                                          COLORS, {}, settings);
+            fast.start(5);
+            slow.start(25);
+            std::printf("%6s %8s %7s %7s %7s %10s %9s\n", "sample", "in view", "missed", "wrong", "found",
+                        "mean late", "max late");
+            std::printf("%6s %8s %7s %7s %7s %10s %9s\n", "(ms)", "(deg)", "", "", "", "(ms)", "(ms)");
+            detect(fast, slow, RING_LENGTH);
+            detect(fast, slow, EDGE_ON);
+            std::printf("\n");
+            std::printf("%6s %8s %9s %7s %11s\n", "loop", "spacing", "rings/s", "thrown", "mis-ejects");
+            std::printf("%6s %8s %9s %7s %11s\n", "(ms)", "(deg)", "", "", "");
+            for (std::uint32_t period : {10u, 25u}) {
+                // closing the rings up until the first mis-eject
+                double best = 0;
+                bool clean = true;
+                for (double spacing : {900.0, 800.0, 700.0, 600.0, 500.0, 400.0, 300.0, 250.0}) {
+                    const Result result = run(period, spacing);
+                    std::printf("%6u %8.0f %9.2f %7d %11d\n", (unsigned)period, spacing, result.rate, result.thrown,
+                                result.misEjects);
+                    clean = clean && result.misEjects == 0;
+                    if (clean) best = result.rate;
+                }
+                std::printf("%u ms loop: %.2f rings/s sorted without a mis-eject\n", (unsigned)period, best);
+            }
+        },
+        600000);
+    return finished ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+// telemetrybench: cost of logging from a control task, through lemlib's
+// BufferedStdout and through the robot::telemetry rings.
+//
+//     ./bin/telemetrybench
+//
+// One producer thread logs a pose sample (time, x, y, theta) while a drainer
+// thread writes the messages out as text lines to /dev/null. The BufferedStdout
+// side reproduces lemlib::Buffer as LemLib 0.5.4 implements it: the producer
+// formats a std::string and appends it to a std::deque under a mutex, and the
+// drainer prints the front message while holding that mutex. Its drainer does
+// not sleep between messages here (LemLib waits `rate` ms after each one), so
+// these are its best case numbers. The ring side pushes a fixed size binary
+// record and the drainer formats it.
+//
+// "burst" pushes as fast as possible, "paced" pushes every 50 us like a busy
+// control loop. Latency is the time one push call takes; msgs/s counts messages
+// written out per second until the drainer caught up. The ring drops records
+// instead of waiting when it is full, those are counted.
+#include "telemetry.hpp"
+#define FMT_HEADER_ONLY
+#include "fmt/core.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr int BURST = 200000;
+constexpr int PACED = 20000;
+constexpr auto PACE = std::chrono::microseconds(50);
+constexpr uint32_t RING = 1024;
+
+struct Result {
+        double seconds = 0; // first push until everything was written
+        int written = 0;
+        int dropped = 0;
+        std::vector<std::uint32_t> latency; // ns per push
+};
+
+// lemlib::Buffer (src/lemlib/logger/buffer.cpp) with host threads
+class LemlibBuffer {
+    public:
+        explicit LemlibBuffer(FILE* file)
+            : file(file),
+              task([this] { taskLoop(); }) {}
+
+        ~LemlibBuffer() { finish(); }
+
+        // wait for the backlog to be written and stop the drainer
+        void finish() {
+            stop = true;
+            if (task.joinable()) task.join();
+        }
+
+        template <typename... T> void print(fmt::format_string<T...> format, T&&... args) {
+            pushToBuffer(fmt::format(format, std::forward<T>(args)...));
+        }
+
+        void pushToBuffer(const std::string& bufferData) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffer.push_back(bufferData);
+        }
+
+        int written = 0;
+    private:
+        void taskLoop() {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!buffer.empty()) {
+                        std::fputs(buffer.at(0).c_str(), file);
+                        buffer.pop_front();
+                        written++;
+                        continue;
+                    }
+                    if (stop) return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        FILE* file;
+        std::deque<std::string> buffer;
+        std::mutex mutex;
+        std::atomic<bool> stop = false;
+        std::thread task;
+};
+
+template <typename Push> void produce(int count, bool paced, Result& result, Push&& push) {
+    result.latency.reserve(count);
+    Clock::time_point next = Clock::now();
+    for (int i = 0; i < count; i++) {
+        if (paced) {
+            next += PACE;
+            while (Clock::now() < next) {}
+        }
+        const float x = i * 0.01f, y = i * -0.02f, theta = i * 0.1f;
+        const Clock::time_point start = Clock::now();
+        push(std::uint32_t(i), x, y, theta);
+        const Clock::time_point end = Clock::now();
+        result.latency.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+}
+
+Result runBuffer(FILE* file, int count, bool paced) {
+    Result result;
+    const Clock::time_point start = Clock::now();
+    LemlibBuffer buffer(file);
+    produce(count, paced, result, [&](std::uint32_t time, float x, float y, float theta) {
+        buffer.print("{},{},{},{}\n", time, x, y, theta);
+    });
+    buffer.finish();
+    result.written = buffer.written;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+Result runRing(FILE* file, int count, bool paced) {
+    using namespace robot::telemetry;
+    Result result;
+    auto ring = std::make_unique<Ring<RING>>();
+    Drainer drainer([file](const Record& record) { printText(record, file); });
+    drainer.add(*ring);
+    std::atomic<bool> stop = false;
+
+    const Clock::time_point start = Clock::now();
+    std::thread task([&] {
+        while (!stop || ring->size() > 0) {
+            if (drainer.drain() == 0) std::this_thread::yield();
+        }
+    });
+    produce(count, paced, result, [&](std::uint32_t time, float x, float y, float theta) {
+        ring->push({time, 1, 3, {x, y, theta}});
+    });
+    stop = true;
+    task.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.written = drainer.written();
+    result.dropped = drainer.dropped();
+    return result;
+}
+
+void print(const char* name, const char* load, Result& result) {
+    std::vector<std::uint32_t>& latency = result.latency;
+    std::sort(latency.begin(), latency.end());
+    std::printf("%-16s %-6s %10.0f %8d %8u %8u %10u\n", name, load, result.written / result.seconds, result.dropped,
+                latency[latency.size() / 2], latency[latency.size() * 99 / 100], latency.back());
+}
+} // namespace
+
+int main() {
+    FILE* file = std::fopen("/dev/null", "w");
+    if (file == nullptr) {
+        std::perror("/dev/null");
+        return 1;
+    }
+    std::printf("%-16s %-6s %10s %8s %8s %8s %10s\n", "logger", "load", "msgs/s", "dropped", "p50 ns", "p99 ns",
+                "worst ns");
+    for (bool paced : {false, true}) {
+        const int count = paced ? PACED : BURST;
+        const char* load = paced ? "paced" : "burst";
+        Result buffer = runBuffer(file, count, paced);
+        print("BufferedStdout", load, buffer);
+        Result ring = runRing(file, count, paced);
+        print("telemetry::Ring", load, ring);
+    }
+    std::fclose(file);
+}
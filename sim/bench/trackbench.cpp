@@ -0,0 +1,110 @@
+// trackbench: tracking error and time of Chassis::follow's path trackers.
+//
+//     ./bin/trackbench
+//
+// Puts the simulated robot at rest on the start of each path, facing along it,
+// and follows the path once per tracker. "time" is how long the motion took;
+// the errors are how far the true pose strayed from the path (distance to the
+// nearest point on it, sampled every 10 ms while the motion runs) and how far
+// from the end of the path the robot came to rest.
+#include "main.h"
+#include "chassis.hpp"
+#include "config.hpp"
+#include "path.hpp"
+#include "sim/kernel.hpp"
+#include "sim/model.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+PATH_ASSET(Skill1)
+PATH_ASSET(RedStakeRush)
+
+namespace {
+constexpr int TIMEOUT = 5000; // ms
+
+struct Case {
+        const char* name;
+        const asset* path;
+        robot::FollowParams params;
+};
+
+// lookaheads are the ones the routines in auto.cpp use
+const Case CASES[] = {
+    {"Skill1", &Skill1_path, {true, robot::Tracker::PURE_PURSUIT, 12}},
+    {"Skill1", &Skill1_path, {true, robot::Tracker::RAMSETE}},
+    {"RedStakeRush", &RedStakeRush_path, {true, robot::Tracker::PURE_PURSUIT, 10}},
+    {"RedStakeRush", &RedStakeRush_path, {true, robot::Tracker::RAMSETE}},
+};
+
+// distance from (x, y) to the path up to waypoint last
+double pathError(const robot::path::PathView& points, int last, double x, double y) {
+    double best = INFINITY;
+    for (int i = 0; i < last; i++) {
+        const robot::path::Waypoint& a = points[i];
+        const robot::path::Waypoint& b = points[i + 1];
+        const double dx = b.x - a.x;
+        const double dy = b.y - a.y;
+        const double span = dx * dx + dy * dy;
+        const double t = span == 0 ? 0 : std::clamp(((x - a.x) * dx + (y - a.y) * dy) / span, 0.0, 1.0);
+        best = std::min(best, std::hypot(a.x + dx * t - x, a.y + dy * t - y));
+    }
+    return best;
+}
+
+void run(const Case& test) {
+    robot::path::PathView points(*test.path);
+    // follow() stops at the first zero speed waypoint
+    int last = points.size() - 1;
+    for (int i = 1; i < points.size(); i++) {
+        if (points[i].speed == 0) {
+            last = i;
+            break;
+        }
+    }
+    int ahead = 1;
+    while (ahead < last && points[ahead].distance < 3) ahead++;
+    const double theta = std::atan2(points[ahead].x - points[0].x, points[ahead].y - points[0].y) * 180 / M_PI;
+
+    sim::World& world = sim::world();
+    for (int port = 0; port < sim::World::PORTS; port++) world.motor(port).velocity = 0;
+    world.pose = {points[0].x, points[0].y, theta};
+    world.placed = true;
+    robot::drivetrain::chassis.setPose(points[0].x, points[0].y, theta);
+
+    const std::uint32_t start = pros::millis();
+    robot::drivetrain::chassis.follow(*test.path, TIMEOUT, test.params);
+    double total = 0;
+    double worst = 0;
+    int samples = 0;
+    while (robot::drivetrain::chassis.isInMotion()) {
+        const double error = pathError(points, last, world.pose.x, world.pose.y);
+        total += error;
+        worst = std::max(worst, error);
+        samples++;
+        pros::delay(10);
+    }
+    const std::uint32_t time = pros::millis() - start;
+    // pure pursuit hands over still moving; see where the robot comes to rest
+    pros::delay(500);
+    const double end = std::hypot(points[last].x - world.pose.x, points[last].y - world.pose.y);
+    std::printf("%-14s %-13s %8u %10.2f %9.2f %9.2f\n", test.name,
+                test.params.tracker == robot::Tracker::RAMSETE ? "ramsete" : "pure pursuit", (unsigned)time,
+                samples == 0 ? 0 : total / samples, worst, end);
+}
+} // namespace
+
+int main() {
+    sim::attachModel();
+    const bool finished = sim::run(
+        []() {
+            initialize();
+            std::printf("%-14s %-13s %8s %10s %9s %9s\n", "path", "tracker", "time", "mean err", "max err",
+                        "end err");
+            std::printf("%-14s %-13s %8s %10s %9s %9s\n", "", "", "(ms)", "(in)", "(in)", "(in)");
+            for (const Case& test : CASES) run(test);
+        },
+        60000);
+    return finished ? 0 : 1;
+}
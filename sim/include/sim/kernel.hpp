@@ -0,0 +1,51 @@
+// sim/kernel.hpp
+//
+// Lockstep virtual-time scheduler standing in for the PROS/FreeRTOS kernel.
+// Every pros::Task runs on its own host thread, but only one of them holds the
+// CPU at a time. When the running task sleeps, the kernel hands the CPU to the
+// task with the earliest wake time, stepping the physics world up to that time
+// first. Nothing ever waits on the wall clock, so routines run as fast as the
+// host can execute them and every run is deterministic.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace sim {
+/**
+ * @brief current virtual time in microseconds
+ */
+std::uint64_t now();
+
+/**
+ * @brief block the calling task until the given virtual time
+ */
+void sleepUntil(std::uint64_t time);
+
+/**
+ * @brief create a task. It first runs when the calling task next sleeps.
+ *
+ * @return task id
+ */
+int spawn(std::function<void()> function, const std::string& name);
+
+/**
+ * @brief run the given function as the first task until it returns or the virtual time limit
+ *
+ * @param function body of the main task
+ * @param limit virtual time limit in milliseconds
+ * @return true if the main task returned before the limit
+ */
+bool run(std::function<void()> function, std::uint32_t limit);
+
+/**
+ * @brief id of the calling task, or -1 outside the simulated tasks
+ */
+int currentTask();
+
+/**
+ * @brief number of context switches performed so far
+ */
+std::uint64_t switches();
+} // namespace sim
@@ -0,0 +1,22 @@
+// sim/model.hpp
+//
+// Couples the simulated sensors to the mechanisms of this robot. Port numbers
+// match src/config.cpp.
+#pragma once
+
+namespace sim {
+/**
+ * @brief sensor faults and extra devices for a run, off by default so the golden numbers see ideal sensors
+ */
+struct ModelOptions {
+        // the tracking wheel reads 1% long, the IMU turns 0.5% over and drifts 1 deg a minute
+        bool drift = false;
+        // plug in the GPS: 30 ms latency, 10 mm noise and dropouts of up to a second when it loses the strip
+        bool gps = false;
+};
+
+/**
+ * @brief wire the robot's sensors to the world. Call once before initialize().
+ */
+void attachModel(const ModelOptions& options = {});
+} // namespace sim
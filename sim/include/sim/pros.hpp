@@ -0,0 +1,392 @@
+// sim/pros.hpp
+//
+// Host-side stand-in for the subset of the PROS kernel API the robot code uses.
+// The simulator build force-includes this header (-include sim/pros.hpp) before
+// every translation unit. It declares the shim types and then defines the
+// include guards of the real PROS headers, so `#include "api.h"` and friends
+// compile to nothing and src/*.cpp bind to these declarations instead.
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Suppress the real kernel headers (see the comment at the top of the file)
+#define _PROS_API_H_
+#define _PROS_API_EXTENDED_H_
+#define _PROS_ADI_H_
+#define _PROS_COLORS_H_
+#define _PROS_DEVICE_H_
+#define _PROS_DISTANCE_H_
+#define _PROS_ERROR_H_
+#define _PROS_EXT_ADI_H_
+#define _PROS_GPS_H_
+#define _PROS_IMU_H_
+#define _PROS_LINK_H_
+#define _PROS_LLEMU_H_
+#define _PROS_MISC_H_
+#define _PROS_MOTORS_H_
+#define _PROS_OPTICAL_H_
+#define _PROS_ROTATION_H_
+#define _PROS_RTOS_H_
+#define _PROS_SCREEN_H_
+#define _PROS_SERIAL_H_
+#define _PROS_VISION_H_
+#define _PROS_ABSTRACT_MOTORS_HPP_
+#define _PROS_ADI_HPP_
+#define _PROS_COLORS_HPP_
+#define _PROS_DEVICE_HPP_
+#define _PROS_DISTANCE_HPP_
+#define _PROS_GPS_HPP_
+#define _PROS_IMU_HPP_
+#define _PROS_LINK_HPP_
+#define _PROS_LLEMU_HPP_
+#define _PROS_MISC_HPP_
+#define _PROS_MOTOR_GROUP_HPP_
+#define _PROS_MOTORS_HPP_
+#define _PROS_OPTICAL_HPP_
+#define _PROS_ROTATION_HPP_
+#define _PROS_RTOS_HPP_
+#define _PROS_SCREEN_HPP_
+#define _PROS_SERIAL_HPP_
+#define _PROS_VISION_HPP_
+
+#define PROS_ERR (INT32_MAX)
+#define PROS_ERR_F (INFINITY)
+#define TASK_PRIORITY_DEFAULT 8
+#define TASK_PRIORITY_MAX 16
+#define TASK_PRIORITY_MIN 1
+#define TASK_STACK_DEPTH_DEFAULT 0x2000
+#define TIMEOUT_MAX ((uint32_t)0xffffffffUL)
+
+namespace pros {
+// RTOS
+typedef void* task_t;
+
+std::uint32_t millis();
+std::uint64_t micros();
+void delay(std::uint32_t milliseconds);
+
+class Task {
+    public:
+        Task(void (*function)(void*), void* parameters = nullptr, const char* name = "");
+        Task(void (*function)(void*), void* parameters, std::uint32_t prio, std::uint16_t stack_depth,
+             const char* name = "");
+
+        template <class F> Task(F&& function, const char* name = "") {
+            start(std::function<void()>(std::forward<F>(function)), name);
+        }
+
+        template <class F>
+        Task(F&& function, std::uint32_t prio, std::uint16_t stack_depth = TASK_STACK_DEPTH_DEFAULT,
+             const char* name = "") {
+            start(std::function<void()>(std::forward<F>(function)), name);
+        }
+
+        static void delay(std::uint32_t milliseconds);
+        static void delay_until(std::uint32_t* const prev_time, std::uint32_t delta);
+    private:
+        void start(std::function<void()> function, const char* name);
+        int id = -1;
+};
+
+class Mutex {
+    public:
+        bool take();
+        bool take(std::uint32_t timeout);
+        bool give();
+        void lock();
+        void unlock();
+    private:
+        bool locked = false;
+};
+
+namespace competition {
+std::uint8_t get_status();
+std::uint8_t is_autonomous();
+std::uint8_t is_connected();
+std::uint8_t is_disabled();
+} // namespace competition
+
+// Controller
+typedef enum { E_CONTROLLER_MASTER = 0, E_CONTROLLER_PARTNER } controller_id_e_t;
+
+typedef enum {
+    E_CONTROLLER_ANALOG_LEFT_X = 0,
+    E_CONTROLLER_ANALOG_LEFT_Y,
+    E_CONTROLLER_ANALOG_RIGHT_X,
+    E_CONTROLLER_ANALOG_RIGHT_Y
+} controller_analog_e_t;
+
+typedef enum {
+    E_CONTROLLER_DIGITAL_L1 = 6,
+    E_CONTROLLER_DIGITAL_L2,
+    E_CONTROLLER_DIGITAL_R1,
+    E_CONTROLLER_DIGITAL_R2,
+    E_CONTROLLER_DIGITAL_UP,
+    E_CONTROLLER_DIGITAL_DOWN,
+    E_CONTROLLER_DIGITAL_LEFT,
+    E_CONTROLLER_DIGITAL_RIGHT,
+    E_CONTROLLER_DIGITAL_X,
+    E_CONTROLLER_DIGITAL_B,
+    E_CONTROLLER_DIGITAL_Y,
+    E_CONTROLLER_DIGITAL_A
+} controller_digital_e_t;
+
+class Controller {
+    public:
+        Controller(controller_id_e_t id);
+        std::int32_t is_connected();
+        std::int32_t get_analog(controller_analog_e_t channel);
+        std::int32_t get_digital(controller_digital_e_t button);
+        std::int32_t get_digital_new_press(controller_digital_e_t button);
+        std::int32_t rumble(const char* rumble_pattern);
+        template <typename... Params>
+        std::int32_t print(std::uint8_t line, std::uint8_t col, const char* fmt, Params... args) {
+            return 1;
+        }
+    private:
+        controller_id_e_t id;
+        bool lastDigital[12] = {};
+};
+
+// Motors
+typedef enum motor_brake_mode_e {
+    E_MOTOR_BRAKE_COAST = 0,
+    E_MOTOR_BRAKE_BRAKE = 1,
+    E_MOTOR_BRAKE_HOLD = 2,
+    E_MOTOR_BRAKE_INVALID = INT32_MAX
+} motor_brake_mode_e_t;
+
+enum class MotorBrake { coast = 0, brake = 1, hold = 2, invalid = INT32_MAX };
+
+enum class MotorEncoderUnits { degrees = 0, deg = 0, rotations = 1, counts = 2, invalid = INT32_MAX };
+using MotorUnits = MotorEncoderUnits;
+
+enum class MotorGears {
+    ratio_36_to_1 = 0,
+    red = ratio_36_to_1,
+    rpm_100 = ratio_36_to_1,
+    ratio_18_to_1 = 1,
+    green = ratio_18_to_1,
+    rpm_200 = ratio_18_to_1,
+    ratio_6_to_1 = 2,
+    blue = ratio_6_to_1,
+    rpm_600 = ratio_6_to_1,
+    invalid = INT32_MAX
+};
+using MotorGearset = MotorGears;
+using MotorCart = MotorGears;
+using MotorCartridge = MotorGears;
+using MotorGear = MotorGears;
+
+// The commands are virtual as in pros::AbstractMotor, so the write caches in devices.hpp also see
+// the writes LemLib makes through its pros::MotorGroup pointers
+class Motor {
+    public:
+        Motor(std::int8_t port, MotorGears gearset = MotorGears::invalid,
+              MotorUnits encoder_units = MotorUnits::invalid);
+        virtual ~Motor() = default;
+        virtual std::int32_t move(std::int32_t voltage) const;
+        virtual std::int32_t move_velocity(std::int32_t velocity) const;
+        virtual std::int32_t move_voltage(std::int32_t voltage) const;
+        virtual std::int32_t brake() const;
+        std::int32_t tare_position(std::uint8_t index = 0) const;
+        std::int32_t set_zero_position(double position, std::uint8_t index = 0) const;
+        virtual std::int32_t set_brake_mode(motor_brake_mode_e_t mode, std::uint8_t index = 0) const;
+        virtual std::int32_t set_brake_mode(MotorBrake mode, std::uint8_t index = 0) const;
+        virtual std::int32_t set_brake_mode_all(motor_brake_mode_e_t mode) const;
+        virtual std::int32_t set_brake_mode_all(MotorBrake mode) const;
+        std::int32_t set_gearing(MotorGears gearset, std::uint8_t index = 0) const;
+        double get_position(std::uint8_t index = 0) const;
+        double get_actual_velocity(std::uint8_t index = 0) const;
+        std::int32_t get_target_velocity(std::uint8_t index = 0) const;
+        std::int32_t get_current_draw(std::uint8_t index = 0) const;
+        std::int32_t get_voltage(std::uint8_t index = 0) const;
+        double get_torque(std::uint8_t index = 0) const;
+        double get_efficiency(std::uint8_t index = 0) const;
+        double get_temperature(std::uint8_t index = 0) const;
+        MotorBrake get_brake_mode(std::uint8_t index = 0) const;
+        std::int8_t get_port(std::uint8_t index = 0) const;
+    private:
+        std::int8_t port;
+};
+
+class MotorGroup {
+    public:
+        MotorGroup(std::initializer_list<std::int8_t> ports, MotorGears gearset = MotorGears::invalid,
+                   MotorUnits encoder_units = MotorUnits::invalid);
+        virtual ~MotorGroup() = default;
+        virtual std::int32_t move(std::int32_t voltage) const;
+        virtual std::int32_t move_velocity(std::int32_t velocity) const;
+        virtual std::int32_t move_voltage(std::int32_t voltage) const;
+        virtual std::int32_t brake() const;
+        std::int32_t tare_position(std::uint8_t index = 0) const;
+        std::int32_t tare_position_all() const;
+        virtual std::int32_t set_brake_mode(motor_brake_mode_e_t mode, std::uint8_t index = 0) const;
+        virtual std::int32_t set_brake_mode(MotorBrake mode, std::uint8_t index = 0) const;
+        virtual std::int32_t set_brake_mode_all(motor_brake_mode_e_t mode) const;
+        virtual std::int32_t set_brake_mode_all(MotorBrake mode) const;
+        double get_position(std::uint8_t index = 0) const;
+        std::vector<double> get_position_all() const;
+        double get_actual_velocity(std::uint8_t index = 0) const;
+        std::vector<double> get_actual_velocity_all() const;
+        std::int32_t get_current_draw(std::uint8_t index = 0) const;
+        std::vector<std::int32_t> get_current_draw_all() const;
+        std::vector<std::int32_t> get_voltage_all() const;
+        MotorGears get_gearing(std::uint8_t index = 0) const;
+        std::vector<std::int8_t> get_port_all() const;
+        std::int8_t size() const;
+    private:
+        std::vector<std::int8_t> ports;
+        MotorGears gearset;
+};
+
+// Three-wire ports
+namespace adi {
+class DigitalOut {
+    public:
+        DigitalOut(std::uint8_t adi_port, bool init_state = false);
+        std::int32_t set_value(bool value) const;
+        std::uint8_t get_port() const;
+    private:
+        std::uint8_t port;
+};
+
+class Encoder {
+    public:
+        Encoder(std::uint8_t adi_port_top, std::uint8_t adi_port_bottom, bool reversed = false);
+        std::int32_t get_value() const;
+        std::int32_t reset() const;
+};
+} // namespace adi
+
+using ADIDigitalOut = adi::DigitalOut;
+using ADIEncoder = adi::Encoder;
+
+// Smart sensors
+class Rotation {
+    public:
+        Rotation(std::int8_t port);
+        std::int32_t reset();
+        std::int32_t reset_position() const;
+        std::int32_t set_position(std::uint32_t position) const;
+        std::int32_t get_position() const;
+        std::int32_t get_velocity() const;
+        std::int32_t get_angle() const;
+        std::int32_t set_data_rate(std::uint32_t rate) const;
+        std::uint8_t get_port() const;
+    private:
+        std::uint8_t port;
+        bool reversed;
+};
+
+struct imu_raw_s {
+        double x;
+        double y;
+        double z;
+};
+typedef struct imu_raw_s imu_gyro_s_t;
+
+class Imu {
+    public:
+        Imu(std::uint8_t port);
+        std::int32_t reset(bool blocking = false) const;
+        bool is_calibrating() const;
+        double get_heading() const;
+        double get_rotation() const;
+        imu_gyro_s_t get_gyro_rate() const;
+        std::int32_t set_heading(double target) const;
+        std::int32_t set_rotation(double target) const;
+        std::int32_t tare() const;
+        std::int32_t set_data_rate(std::uint32_t rate) const;
+        std::uint8_t get_port() const;
+    private:
+        std::uint8_t port;
+};
+
+// the C API types live in pros::c
+namespace c {
+typedef struct optical_rgb_s {
+        double red;
+        double green;
+        double blue;
+        double brightness;
+} optical_rgb_s_t;
+
+task_t task_get_current();
+} // namespace c
+
+class Optical {
+    public:
+        Optical(std::uint8_t port);
+        double get_hue();
+        double get_saturation();
+        double get_brightness();
+        std::int32_t get_proximity();
+        c::optical_rgb_s_t get_rgb();
+        std::int32_t set_led_pwm(std::uint8_t value);
+        std::int32_t get_led_pwm();
+        std::int32_t set_integration_time(double time);
+        std::int32_t enable_gesture();
+        std::int32_t disable_gesture();
+        double get_integration_time();
+        std::uint8_t get_port() const;
+    private:
+        std::uint8_t port;
+};
+
+class Gps {
+    public:
+        Gps(std::uint8_t port);
+        Gps(std::uint8_t port, double xOffset, double yOffset);
+        double get_position_x() const;
+        double get_position_y() const;
+        double get_heading() const;
+        double get_error() const;
+        std::int32_t set_data_rate(std::uint32_t rate) const;
+        std::uint8_t get_port() const;
+    private:
+        std::uint8_t port;
+};
+
+class Distance {
+    public:
+        Distance(std::uint8_t port);
+        std::int32_t get();
+        std::int32_t get_distance();
+        std::int32_t get_confidence();
+        std::int32_t get_object_size();
+        double get_object_velocity();
+        std::uint8_t get_port() const;
+    private:
+        std::uint8_t port;
+};
+
+// Brain screen
+#define LCD_BTN_LEFT 4
+#define LCD_BTN_CENTER 2
+#define LCD_BTN_RIGHT 1
+
+namespace lcd {
+bool initialize();
+bool is_initialized();
+bool clear();
+bool clear_line(std::int16_t line);
+bool set_text(std::int16_t line, std::string text);
+std::uint8_t read_buttons();
+
+template <typename... Params> bool print(std::int16_t line, const char* fmt, Params... args) {
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), fmt, args...);
+    return set_text(line, buffer);
+}
+} // namespace lcd
+} // namespace pros
@@ -0,0 +1,139 @@
+// sim/report.hpp
+//
+// Per-motion timing collected while a routine runs in the simulator, and the
+// time budget of the autonomous task: every microsecond it spends is charged
+// to the innermost open Scope, or to "delay" when it sleeps outside of one.
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sim {
+struct MotionRecord {
+        std::string name;
+        std::uint32_t start = 0; // ms
+        std::uint32_t end = 0; // ms
+        std::string exit = "running";
+        std::uint32_t near = 0; // ms, first time within the large error range, 0 if never
+
+        /**
+         * @brief time a timed out motion spent after getting within its large error range, or all of it if it
+         * never did (ms)
+         */
+        std::uint32_t lost() const;
+};
+
+struct Golden {
+        std::uint32_t total = 0; // ms
+        int timeouts = 0;
+};
+
+class Report {
+    public:
+        /**
+         * @brief note that a motion started executing
+         *
+         * @return handle to pass to motionNear and motionEnded
+         */
+        int motionStarted(const std::string& name);
+        void motionNear(int handle);
+        void motionEnded(int handle, const std::string& exit);
+
+        /**
+         * @brief account the autonomous task's time from now on to the given category
+         */
+        void enter(const std::string& category);
+        void leave();
+
+        /**
+         * @brief called by pros::delay around every sleep
+         */
+        void sleepStarted();
+        void sleepEnded();
+
+        /**
+         * @brief start tracking the calling task's time budget
+         */
+        void track();
+
+        /**
+         * @brief note how far the robot's pose estimate is off the true pose (in, deg)
+         */
+        void sampleDrift(double position, double heading);
+
+        /**
+         * @brief print the routine summary, the per-motion table and the time budget to stdout
+         */
+        void print(const std::string& routine, double wallSeconds) const;
+
+        /**
+         * @brief compare against the golden numbers of the routine
+         *
+         * @return false if the routine got slower or timed out more often
+         */
+        bool check(const std::string& routine, const std::string& path) const;
+
+        /**
+         * @brief replace the golden numbers of the routine with this run
+         */
+        void update(const std::string& routine, const std::string& path) const;
+
+        std::uint32_t start = 0;
+        std::uint32_t end = 0;
+        std::uint32_t limit = 0;
+        bool finished = false;
+        std::vector<MotionRecord> motions;
+        std::map<std::string, std::uint64_t> budget; // us per category
+        // odometry error against the true pose, at the last sample and the largest seen
+        double drift = 0; // in
+        double headingDrift = 0; // deg
+        double maxDrift = 0;
+        double maxHeadingDrift = 0;
+        bool mirrored = false; // the routine's poses aren't the field's (mirrored_frame()), drift is meaningless
+    private:
+        bool tracked() const;
+        void account();
+
+        int task = -1;
+        std::uint64_t mark = 0;
+        std::vector<std::string> scopes;
+};
+
+Report& report();
+
+/**
+ * @brief charges the autonomous task's time to a category while in scope
+ */
+class Scope {
+    public:
+        explicit Scope(const std::string& category) { report().enter(category); }
+
+        ~Scope() { report().leave(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+};
+
+/**
+ * @brief records a motion in the per-motion table while in scope
+ */
+class MotionScope {
+    public:
+        explicit MotionScope(const std::string& name)
+            : handle(report().motionStarted(name)) {}
+
+        ~MotionScope() { report().motionEnded(handle, reason); }
+
+        void near() { report().motionNear(handle); }
+
+        void exit(const std::string& reason) { this->reason = reason; }
+
+        MotionScope(const MotionScope&) = delete;
+        MotionScope& operator=(const MotionScope&) = delete;
+    private:
+        int handle;
+        std::string reason = "settled";
+};
+} // namespace sim
@@ -0,0 +1,128 @@
+// sim/world.hpp
+//
+// Physics and device state behind the PROS shim. Motors are first order
+// systems tracking either a voltage or a velocity command, the drivetrain is a
+// differential-drive unicycle driven by its motor groups, and sensors read
+// from whatever the robot model couples them to.
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim {
+/**
+ * @brief ground-truth pose. Inches and degrees, 0 = +y, clockwise positive (same as LemLib)
+ */
+struct Pose {
+        double x = 0;
+        double y = 0;
+        double theta = 0;
+};
+
+struct MotorState {
+        enum class Mode { VOLTAGE, VELOCITY };
+
+        Mode mode = Mode::VOLTAGE;
+        double command = 0; // mV or rpm, depending on mode
+        double freeSpeed = 200; // rpm at 12 V
+        double tau = 0.05; // time constant (s)
+        int brakeMode = 0; // pros::motor_brake_mode_e_t
+        double velocity = 0; // rpm
+        double position = 0; // degrees
+        double current = 0; // mA
+        double voltage = 0; // mV actually applied
+        double minPosition = -INFINITY; // degrees, a hard stop the mechanism rests on
+        std::uint32_t writes = 0; // commands received
+};
+
+struct AdiEvent {
+        std::uint32_t time;
+        char port;
+        bool value;
+};
+
+/**
+ * @brief what the GPS sensor reports. Metres from the field centre and degrees, 0 = +y, clockwise
+ */
+struct GpsReading {
+        double x = 0;
+        double y = 0;
+        double heading = 0; // 0 - 360
+        double error = 0; // m, the sensor's own RMS estimate
+};
+
+class World {
+    public:
+        static constexpr int PORTS = 22;
+        static constexpr double FIELD_HALF_WIDTH = 72;
+        static constexpr double ROBOT_HALF_WIDTH = 7.5;
+
+        MotorState& motor(int port);
+
+        /**
+         * @brief couple the drivetrain model to the given signed motor ports
+         */
+        void attachDrivetrain(const std::vector<std::int8_t>& left, const std::vector<std::int8_t>& right,
+                              double trackWidth, double wheelDiameter, double rpm);
+
+        /**
+         * @brief put the robot on the field. Only the first call moves it, later calls are odometry resets.
+         */
+        void place(const Pose& pose);
+
+        /**
+         * @brief advance the world by dt seconds
+         */
+        void step(double dt);
+
+        Pose pose;
+        bool placed = false;
+        double distance = 0; // forward distance driven by the robot centre (in)
+        double yawRate = 0; // deg/s, clockwise positive
+        double time = 0; // s simulated
+
+        // IMU errors: scale on the turning it sees and a constant bias (deg/s)
+        double imuScale = 1;
+        double imuBias = 0;
+        // the GPS reads from its source, or PROS_ERR_F without one (unplugged)
+        std::function<GpsReading()> gpsSource;
+        // called after every step, for models that keep a history
+        std::function<void()> afterStep;
+
+        // rotation sensors read centidegrees from their source, offset by the last reset
+        std::array<std::function<double()>, PORTS> rotationSource {};
+        // distance sensors read millimetres from their source, 9999 for nothing in range
+        std::array<std::function<double()>, PORTS> distanceSource {};
+        // rpm a load (gravity on an arm) takes off a motor's speed, positive pulling it backwards
+        std::array<std::function<double()>, PORTS> loadSource {};
+        std::array<double, PORTS> rotationOffset {};
+
+        // optical sensor reading
+        double hue = 60;
+        double saturation = 0.1;
+        double brightness = 0.2;
+        int proximity = 0;
+
+        // competition state reported to the robot code
+        bool autonomous = false;
+
+        // three-wire digital outputs, indexed by port letter
+        std::array<bool, 8> adi {};
+        std::vector<AdiEvent> adiLog;
+        // brain screen lines as last printed
+        std::array<std::string, 8> screen {};
+    private:
+        std::array<MotorState, PORTS> motors {};
+        std::vector<std::int8_t> leftPorts;
+        std::vector<std::int8_t> rightPorts;
+        double trackWidth = 0;
+        double wheelDiameter = 0;
+        double wheelRpm = 0;
+};
+
+World& world();
+} // namespace sim
@@ -0,0 +1,141 @@
+#include "sim/kernel.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim {
+namespace {
+// physics is integrated in steps no longer than this (us)
+constexpr std::uint64_t MAX_STEP = 1000;
+
+struct Task {
+        int id;
+        std::string name;
+        std::uint64_t wake = 0;
+        std::uint64_t seq = 0;
+        bool done = false;
+        std::condition_variable cv;
+};
+
+struct Kernel {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::vector<std::unique_ptr<Task>> tasks;
+        std::uint64_t now = 0;
+        std::uint64_t seq = 0;
+        std::uint64_t limit = UINT64_MAX;
+        std::uint64_t switches = 0;
+        Task* running = nullptr;
+        bool stopped = true;
+};
+
+// leaked on purpose: abandoned task threads still wait on it at exit
+Kernel& kernel() {
+    static Kernel* instance = new Kernel();
+    return *instance;
+}
+
+thread_local Task* self = nullptr;
+
+// hand the CPU to the next task. Called with the kernel lock held.
+void dispatch() {
+    Kernel& k = kernel();
+    Task* next = nullptr;
+    for (auto& task : k.tasks) {
+        if (task->done) continue;
+        if (next == nullptr || task->wake < next->wake || (task->wake == next->wake && task->seq < next->seq)) {
+            next = task.get();
+        }
+    }
+    if (k.stopped || next == nullptr || next->wake > k.limit) {
+        k.stopped = true;
+        k.running = nullptr;
+        k.idle.notify_all();
+        return;
+    }
+    while (k.now < next->wake) {
+        const std::uint64_t step = std::min(next->wake - k.now, MAX_STEP);
+        world().step(step / 1e6);
+        k.now += step;
+    }
+    if (next != k.running) k.switches++;
+    k.running = next;
+    next->cv.notify_one();
+}
+
+void waitTurn(std::unique_lock<std::mutex>& lock) {
+    while (kernel().running != self) self->cv.wait(lock);
+}
+} // namespace
+
+std::uint64_t now() { return kernel().now; }
+
+std::uint64_t switches() { return kernel().switches; }
+
+int currentTask() { return self == nullptr ? -1 : self->id; }
+
+void sleepUntil(std::uint64_t time) {
+    Kernel& k = kernel();
+    std::unique_lock<std::mutex> lock(k.mutex);
+    if (self == nullptr) {
+        // not a simulated task (e.g. static initialisation): nothing to hand over
+        k.now = std::max(k.now, time);
+        return;
+    }
+    self->wake = std::max(time, k.now);
+    self->seq = ++k.seq;
+    dispatch();
+    waitTurn(lock);
+}
+
+int spawn(std::function<void()> function, const std::string& name) {
+    Kernel& k = kernel();
+    std::unique_lock<std::mutex> lock(k.mutex);
+    auto task = std::make_unique<Task>();
+    Task* handle = task.get();
+    handle->id = static_cast<int>(k.tasks.size());
+    handle->name = name;
+    handle->wake = k.now;
+    handle->seq = ++k.seq;
+    k.tasks.push_back(std::move(task));
+    std::thread([handle, function = std::move(function)]() {
+        Kernel& k = kernel();
+        self = handle;
+        {
+            std::unique_lock<std::mutex> lock(k.mutex);
+            waitTurn(lock);
+        }
+        function();
+        std::unique_lock<std::mutex> lock(k.mutex);
+        handle->done = true;
+        dispatch();
+    }).detach();
+    return handle->id;
+}
+
+bool run(std::function<void()> function, std::uint32_t limit) {
+    Kernel& k = kernel();
+    bool finished = false;
+    {
+        std::unique_lock<std::mutex> lock(k.mutex);
+        k.limit = k.now + static_cast<std::uint64_t>(limit) * 1000;
+        k.stopped = false;
+    }
+    spawn(
+        [&]() {
+            function();
+            std::unique_lock<std::mutex> lock(k.mutex);
+            finished = true;
+            k.stopped = true;
+        },
+        "main");
+    std::unique_lock<std::mutex> lock(k.mutex);
+    dispatch();
+    k.idle.wait(lock, [&]() { return k.stopped && k.running == nullptr; });
+    return finished;
+}
+} // namespace sim
@@ -0,0 +1,932 @@
+// Host implementation of the LemLib 0.5 API declared in include/lemlib.
+//
+// The robot links against the prebuilt LemLib archive. The simulator has no
+// such archive, so this file re-implements the parts the robot code uses with
+// the same control structure (motion queue, PID + exit conditions, motion
+// chaining through minSpeed/earlyExitRange, pure pursuit over path.jerryio
+// assets). Every motion is also recorded in sim::report().
+#include "lemlib/api.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/timer.hpp"
+#include "sim/report.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+// compass heading (deg) from one point to another
+float headingTo(const lemlib::Pose& from, const lemlib::Pose& to) {
+    return lemlib::radToDeg(std::atan2(to.x - from.x, to.y - from.y));
+}
+
+float wrap180(float angle) {
+    angle = std::fmod(angle + 180, 360);
+    if (angle < 0) angle += 360;
+    return angle - 180;
+}
+
+// heading error honouring a forced turn direction
+float directedError(float target, float current, lemlib::AngularDirection direction) {
+    switch (direction) {
+        case lemlib::AngularDirection::CW_CLOCKWISE: return std::fmod(std::fmod(target - current, 360) + 360, 360);
+        case lemlib::AngularDirection::CCW_COUNTERCLOCKWISE:
+            return -std::fmod(std::fmod(current - target, 360) + 360, 360);
+        default: return wrap180(target - current);
+    }
+}
+
+std::string describe(const char* format, float a, float b = 0, float c = 0) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), format, a, b, c);
+    return buffer;
+}
+
+// odometry: integrates the ground-truth motion of the robot into the odom frame
+lemlib::Pose odomPose(0, 0, 0); // degrees
+sim::Pose lastTruth;
+bool odomRunning = false;
+
+// path.jerryio asset -> waypoints, speed stored in theta
+std::vector<lemlib::Pose> readPath(const asset& path) {
+    std::vector<lemlib::Pose> points;
+    std::istringstream input(std::string(reinterpret_cast<const char*>(path.buf), path.size));
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.rfind("endData", 0) == 0) break;
+        float x, y, speed;
+        if (std::sscanf(line.c_str(), "%f, %f, %f", &x, &y, &speed) == 3) points.emplace_back(x, y, speed);
+    }
+    return points;
+}
+
+// farthest intersection of segment p1-p2 with a circle, as a fraction along the segment, or -1
+float circleIntersect(const lemlib::Pose& p1, const lemlib::Pose& p2, const lemlib::Pose& center, float radius) {
+    const lemlib::Pose d = p2 - p1;
+    const lemlib::Pose f = p1 - center;
+    const float a = d * d;
+    const float b = 2 * (f * d);
+    const float c = (f * f) - radius * radius;
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0 || a == 0) return -1;
+    discriminant = std::sqrt(discriminant);
+    const float t1 = (-b - discriminant) / (2 * a);
+    const float t2 = (-b + discriminant) / (2 * a);
+    if (t2 >= 0 && t2 <= 1) return t2;
+    if (t1 >= 0 && t1 <= 1) return t1;
+    return -1;
+}
+} // namespace
+
+namespace lemlib {
+// Pose
+Pose::Pose(float x, float y, float theta)
+    : x(x),
+      y(y),
+      theta(theta) {}
+
+Pose Pose::operator+(const Pose& other) const { return Pose(x + other.x, y + other.y, theta); }
+
+Pose Pose::operator-(const Pose& other) const { return Pose(x - other.x, y - other.y, theta); }
+
+float Pose::operator*(const Pose& other) const { return x * other.x + y * other.y; }
+
+Pose Pose::operator*(const float& other) const { return Pose(x * other, y * other, theta); }
+
+Pose Pose::operator/(const float& other) const { return Pose(x / other, y / other, theta); }
+
+Pose Pose::lerp(Pose other, float t) const { return Pose(x + (other.x - x) * t, y + (other.y - y) * t, theta); }
+
+float Pose::distance(Pose other) const { return std::hypot(x - other.x, y - other.y); }
+
+float Pose::angle(Pose other) const { return std::atan2(other.y - y, other.x - x); }
+
+Pose Pose::rotate(float angle) const {
+    return Pose(x * std::cos(angle) - y * std::sin(angle), x * std::sin(angle) + y * std::cos(angle), theta);
+}
+
+std::string format_as(const Pose& pose) {
+    return "lemlib::Pose { x: " + std::to_string(pose.x) + ", y: " + std::to_string(pose.y) +
+           ", theta: " + std::to_string(pose.theta) + " }";
+}
+
+// util
+float slew(float target, float current, float maxChange) {
+    float change = target - current;
+    if (maxChange == 0) return target;
+    if (change > maxChange) change = maxChange;
+    else if (change < -maxChange) change = -maxChange;
+    return current + change;
+}
+
+float angleError(float target, float position, bool radians, AngularDirection direction) {
+    if (radians) return degToRad(directedError(radToDeg(target), radToDeg(position), direction));
+    return directedError(target, position, direction);
+}
+
+float avg(std::vector<float> values) {
+    float sum = 0;
+    for (float value : values) sum += value;
+    return values.empty() ? 0 : sum / values.size();
+}
+
+float ema(float current, float previous, float smooth) { return (current * smooth) + (previous * (1 - smooth)); }
+
+float getCurvature(Pose pose, Pose other) {
+    // curvature of the arc through pose (standard position, radians) tangent to its heading
+    const float side = sgn(std::sin(pose.theta) * (other.x - pose.x) - std::cos(pose.theta) * (other.y - pose.y));
+    const float a = -std::tan(pose.theta);
+    const float c = std::tan(pose.theta) * pose.x - pose.y;
+    const float x = std::fabs(a * other.x + other.y + c) / std::sqrt((a * a) + 1);
+    const float d = std::hypot(other.x - pose.x, other.y - pose.y);
+    return d == 0 ? 0 : side * ((2 * x) / (d * d));
+}
+
+// PID
+PID::PID(float kP, float kI, float kD, float windupRange, bool signFlipReset)
+    : kP(kP),
+      kI(kI),
+      kD(kD),
+      windupRange(windupRange),
+      signFlipReset(signFlipReset) {}
+
+float PID::update(const float error) {
+    integral += error;
+    if (sgn(error) != sgn(prevError) && signFlipReset) integral = 0;
+    if (std::fabs(error) > windupRange && windupRange != 0) integral = 0;
+    const float derivative = error - prevError;
+    prevError = error;
+    return error * kP + integral * kI + derivative * kD;
+}
+
+void PID::reset() {
+    integral = 0;
+    prevError = 0;
+}
+
+// ExitCondition
+ExitCondition::ExitCondition(const float range, const int time)
+    : range(range),
+      time(time) {}
+
+bool ExitCondition::getExit() { return done; }
+
+bool ExitCondition::update(const float input) {
+    const int now = pros::millis();
+    if (std::fabs(input) > range) startTime = -1;
+    else if (startTime == -1) startTime = now;
+    else if (now >= startTime + time) done = true;
+    return done;
+}
+
+void ExitCondition::reset() {
+    startTime = -1;
+    done = false;
+}
+
+// Timer
+Timer::Timer(uint32_t time)
+    : period(time) {
+    lastTime = pros::millis();
+}
+
+uint32_t Timer::getTimeSet() { return period; }
+
+uint32_t Timer::getTimeLeft() {
+    const uint32_t passed = getTimePassed();
+    return passed < period ? period - passed : 0;
+}
+
+uint32_t Timer::getTimePassed() {
+    const uint32_t now = pros::millis();
+    if (!paused) timeWaited += now - lastTime;
+    lastTime = now;
+    return timeWaited;
+}
+
+bool Timer::isDone() { return getTimePassed() >= period; }
+
+bool Timer::isPaused() { return paused; }
+
+void Timer::set(uint32_t time) {
+    period = time;
+    reset();
+}
+
+void Timer::reset() {
+    timeWaited = 0;
+    lastTime = pros::millis();
+}
+
+void Timer::pause() {
+    getTimePassed();
+    paused = true;
+}
+
+void Timer::resume() {
+    lastTime = pros::millis();
+    paused = false;
+}
+
+void Timer::waitUntilDone() {
+    while (!isDone()) pros::delay(5);
+}
+
+// Drive curves
+ExpoDriveCurve::ExpoDriveCurve(float deadband, float minOutput, float curve)
+    : deadband(deadband),
+      minOutput(minOutput),
+      curveGain(curve) {}
+
+float ExpoDriveCurve::curve(float input) {
+    if (std::fabs(input) <= deadband) return 0;
+    const float g = std::fabs(input) - deadband;
+    const float g127 = 127 - deadband;
+    const float i = std::pow(curveGain, g - 127) * g * sgn(input);
+    const float i127 = std::pow(curveGain, g127 - 127) * g127;
+    return (127.0 - minOutput) / 127 * i * 127 / i127 + minOutput * sgn(input);
+}
+
+ExpoDriveCurve defaultDriveCurve(0, 0, 1);
+
+// Sensors
+TrackingWheel::TrackingWheel(pros::adi::Encoder* encoder, float wheelDiameter, float distance, float gearRatio)
+    : diameter(wheelDiameter),
+      distance(distance),
+      encoder(encoder),
+      gearRatio(gearRatio) {}
+
+TrackingWheel::TrackingWheel(pros::Rotation* encoder, float wheelDiameter, float distance, float gearRatio)
+    : diameter(wheelDiameter),
+      distance(distance),
+      rotation(encoder),
+      gearRatio(gearRatio) {}
+
+TrackingWheel::TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm)
+    : diameter(wheelDiameter),
+      distance(distance),
+      rpm(rpm),
+      motors(motors) {}
+
+void TrackingWheel::reset() {
+    if (rotation != nullptr) rotation->reset_position();
+    if (motors != nullptr) motors->tare_position_all();
+}
+
+float TrackingWheel::getDistanceTraveled() {
+    if (rotation != nullptr) return float(rotation->get_position()) * diameter * M_PI / 36000 / gearRatio;
+    if (motors != nullptr) {
+        const std::vector<double> positions = motors->get_position_all();
+        float sum = 0;
+        for (double position : positions) sum += position;
+        return sum / positions.size() / 360 * diameter * M_PI * rpm / 600;
+    }
+    return 0;
+}
+
+float TrackingWheel::getOffset() { return distance; }
+
+int TrackingWheel::getType() { return motors != nullptr ? 1 : 0; }
+
+OdomSensors::OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
+                         TrackingWheel* horizontal2, pros::Imu* imu)
+    : vertical1(vertical1),
+      vertical2(vertical2),
+      horizontal1(horizontal1),
+      horizontal2(horizontal2),
+      imu(imu) {}
+
+Drivetrain::Drivetrain(pros::MotorGroup* leftMotors, pros::MotorGroup* rightMotors, float trackWidth,
+                       float wheelDiameter, float rpm, float horizontalDrift)
+    : leftMotors(leftMotors),
+      rightMotors(rightMotors),
+      trackWidth(trackWidth),
+      wheelDiameter(wheelDiameter),
+      rpm(rpm),
+      horizontalDrift(horizontalDrift) {}
+
+// Odometry
+void setSensors(OdomSensors, Drivetrain) {}
+
+Pose getPose(bool radians) {
+    if (radians) return Pose(odomPose.x, odomPose.y, degToRad(odomPose.theta));
+    return odomPose;
+}
+
+void setPose(Pose pose, bool radians) {
+    if (radians) pose.theta = radToDeg(pose.theta);
+    odomPose = pose;
+    lastTruth = sim::world().pose;
+}
+
+Pose getSpeed(bool radians) {
+    const sim::World& world = sim::world();
+    const float yaw = radians ? degToRad(world.yawRate) : world.yawRate;
+    return Pose(0, 0, yaw);
+}
+
+Pose getLocalSpeed(bool radians) { return getSpeed(radians); }
+
+Pose estimatePose(float time, bool radians) { return getPose(radians); }
+
+void update() {
+    // perfect tracking: replay the ground-truth motion, expressed in the robot frame, in the odom frame
+    const sim::Pose truth = sim::world().pose;
+    const float dx = truth.x - lastTruth.x;
+    const float dy = truth.y - lastTruth.y;
+    const float heading = degToRad(lastTruth.theta);
+    const float forward = dx * std::sin(heading) + dy * std::cos(heading);
+    const float right = dx * std::cos(heading) - dy * std::sin(heading);
+    const float odomHeading = degToRad(odomPose.theta);
+    odomPose.x += forward * std::sin(odomHeading) + right * std::cos(odomHeading);
+    odomPose.y += forward * std::cos(odomHeading) - right * std::sin(odomHeading);
+    odomPose.theta += truth.theta - lastTruth.theta;
+    lastTruth = truth;
+}
+
+void init() {
+    if (odomRunning) return;
+    odomRunning = true;
+    lastTruth = sim::world().pose;
+    pros::Task([]() {
+        while (true) {
+            update();
+            pros::delay(10);
+        }
+    });
+}
+
+// Chassis
+Chassis::Chassis(Drivetrain drivetrain, ControllerSettings linearSettings, ControllerSettings angularSettings,
+                 OdomSensors sensors, DriveCurve* throttleCurve, DriveCurve* steerCurve)
+    : lateralPID(linearSettings.kP, linearSettings.kI, linearSettings.kD, linearSettings.windupRange, true),
+      angularPID(angularSettings.kP, angularSettings.kI, angularSettings.kD, angularSettings.windupRange, true),
+      lateralSettings(linearSettings),
+      angularSettings(angularSettings),
+      drivetrain(drivetrain),
+      sensors(sensors),
+      throttleCurve(throttleCurve),
+      steerCurve(steerCurve),
+      lateralLargeExit(lateralSettings.largeError, lateralSettings.largeErrorTimeout),
+      lateralSmallExit(lateralSettings.smallError, lateralSettings.smallErrorTimeout),
+      angularLargeExit(angularSettings.largeError, angularSettings.largeErrorTimeout),
+      angularSmallExit(angularSettings.smallError, angularSettings.smallErrorTimeout) {
+    sim::world().attachDrivetrain(drivetrain.leftMotors->get_port_all(), drivetrain.rightMotors->get_port_all(),
+                                  drivetrain.trackWidth, drivetrain.wheelDiameter, drivetrain.rpm);
+}
+
+void Chassis::calibrate(bool calibrateIMU) {
+    if (calibrateIMU && sensors.imu != nullptr) sensors.imu->reset(true);
+    if (sensors.vertical1 != nullptr) sensors.vertical1->reset();
+    init();
+}
+
+void Chassis::setPose(float x, float y, float theta, bool radians) { setPose(Pose(x, y, theta), radians); }
+
+// the routine's first setPose places the robot on the field; odometry writing lemlib::setPose does not
+void Chassis::setPose(Pose pose, bool radians) {
+    const float theta = radians ? radToDeg(pose.theta) : pose.theta;
+    sim::world().place({pose.x, pose.y, theta});
+    lemlib::setPose(pose, radians);
+}
+
+Pose Chassis::getPose(bool radians, bool standardPos) {
+    Pose pose = lemlib::getPose(true);
+    if (standardPos) pose.theta = M_PI_2 - pose.theta;
+    if (!radians) pose.theta = radToDeg(pose.theta);
+    return pose;
+}
+
+void Chassis::waitUntil(float dist) {
+    sim::Scope scope("waitUntil");
+    // give the movement time to start
+    pros::delay(10);
+    while (distTraveled < dist && distTraveled != -1) pros::delay(10);
+}
+
+void Chassis::waitUntilDone() {
+    sim::Scope scope("waitUntilDone");
+    do pros::delay(10);
+    while (distTraveled != -1);
+}
+
+void Chassis::setBrakeMode(pros::motor_brake_mode_e mode) {
+    drivetrain.leftMotors->set_brake_mode_all(mode);
+    drivetrain.rightMotors->set_brake_mode_all(mode);
+}
+
+void Chassis::requestMotionStart() {
+    if (isInMotion()) motionQueued = true;
+    else motionRunning = true;
+    // wait until this motion is at the front of the queue
+    sim::Scope scope("queued behind motion");
+    mutex.take(TIMEOUT_MAX);
+}
+
+void Chassis::endMotion() {
+    // move the queue forward by one
+    motionRunning = motionQueued;
+    motionQueued = false;
+    mutex.give();
+}
+
+void Chassis::cancelMotion() {
+    motionRunning = false;
+    pros::delay(10);
+}
+
+void Chassis::cancelAllMotions() {
+    motionRunning = false;
+    motionQueued = false;
+}
+
+bool Chassis::isInMotion() const { return motionRunning; }
+
+void Chassis::resetLocalPosition() {
+    const float theta = getPose().theta;
+    setPose(0, 0, theta);
+}
+
+void Chassis::turnToHeading(float theta, int timeout, TurnToHeadingParams params, bool async) {
+    sim::Scope scope("motion");
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { turnToHeading(theta, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    const int record = sim::report().motionStarted(describe("turnToHeading(%.1f)", theta));
+    const char* exit = "timeout";
+    angularPID.reset();
+    angularLargeExit.reset();
+    angularSmallExit.reset();
+    distTraveled = 0;
+    float prevTheta = getPose().theta;
+    float prevOutput = 0;
+    bool settling = params.direction == AngularDirection::AUTO;
+    Timer timer(timeout);
+    while (!timer.isDone() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled += std::fabs(wrap180(pose.theta - prevTheta));
+        prevTheta = pose.theta;
+        // a forced direction only applies until the robot gets close to the target
+        if (!settling && std::fabs(wrap180(theta - pose.theta)) < 20) settling = true;
+        const float error = directedError(theta, pose.theta, settling ? AngularDirection::AUTO : params.direction);
+        if (std::fabs(error) < angularSettings.largeError) sim::report().motionNear(record);
+        if (params.minSpeed != 0 && std::fabs(error) < params.earlyExitRange) {
+            exit = "early exit";
+            break;
+        }
+        angularLargeExit.update(error);
+        angularSmallExit.update(error);
+        if (angularLargeExit.getExit() || angularSmallExit.getExit()) {
+            exit = "settled";
+            break;
+        }
+        float output = angularPID.update(error);
+        output = std::clamp(output, -float(params.maxSpeed), float(params.maxSpeed));
+        output = slew(output, prevOutput, angularSettings.slew);
+        if (!settling && std::fabs(output) < params.minSpeed) output = sgn(output) * params.minSpeed;
+        prevOutput = output;
+        drivetrain.leftMotors->move(output);
+        drivetrain.rightMotors->move(-output);
+        pros::delay(10);
+    }
+    if (!motionRunning) exit = "cancelled";
+    if (params.minSpeed == 0) {
+        drivetrain.leftMotors->move(0);
+        drivetrain.rightMotors->move(0);
+    }
+    distTraveled = -1;
+    sim::report().motionEnded(record, exit);
+    endMotion();
+}
+
+void Chassis::turnToPoint(float x, float y, int timeout, TurnToPointParams params, bool async) {
+    sim::Scope scope("motion");
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { turnToPoint(x, y, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    const int record = sim::report().motionStarted(describe("turnToPoint(%.1f, %.1f)", x, y));
+    const char* exit = "timeout";
+    const Pose target(x, y);
+    angularPID.reset();
+    angularLargeExit.reset();
+    angularSmallExit.reset();
+    distTraveled = 0;
+    float prevTheta = getPose().theta;
+    float prevOutput = 0;
+    bool settling = params.direction == AngularDirection::AUTO;
+    Timer timer(timeout);
+    while (!timer.isDone() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled += std::fabs(wrap180(pose.theta - prevTheta));
+        prevTheta = pose.theta;
+        const float theta = headingTo(pose, target) + (params.forwards ? 0 : 180);
+        if (!settling && std::fabs(wrap180(theta - pose.theta)) < 20) settling = true;
+        const float error = directedError(theta, pose.theta, settling ? AngularDirection::AUTO : params.direction);
+        if (std::fabs(error) < angularSettings.largeError) sim::report().motionNear(record);
+        if (params.minSpeed != 0 && std::fabs(error) < params.earlyExitRange) {
+            exit = "early exit";
+            break;
+        }
+        angularLargeExit.update(error);
+        angularSmallExit.update(error);
+        if (angularLargeExit.getExit() || angularSmallExit.getExit()) {
+            exit = "settled";
+            break;
+        }
+        float output = angularPID.update(error);
+        output = std::clamp(output, -float(params.maxSpeed), float(params.maxSpeed));
+        output = slew(output, prevOutput, angularSettings.slew);
+        if (!settling && std::fabs(output) < params.minSpeed) output = sgn(output) * params.minSpeed;
+        prevOutput = output;
+        drivetrain.leftMotors->move(output);
+        drivetrain.rightMotors->move(-output);
+        pros::delay(10);
+    }
+    if (!motionRunning) exit = "cancelled";
+    if (params.minSpeed == 0) {
+        drivetrain.leftMotors->move(0);
+        drivetrain.rightMotors->move(0);
+    }
+    distTraveled = -1;
+    sim::report().motionEnded(record, exit);
+    endMotion();
+}
+
+void Chassis::swingToHeading(float theta, DriveSide lockedSide, int timeout, SwingToHeadingParams params,
+                             bool async) {
+    sim::Scope scope("motion");
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { swingToHeading(theta, lockedSide, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    const int record = sim::report().motionStarted(describe("swingToHeading(%.1f)", theta));
+    const char* exit = "timeout";
+    angularPID.reset();
+    angularLargeExit.reset();
+    angularSmallExit.reset();
+    distTraveled = 0;
+    float prevTheta = getPose().theta;
+    float prevOutput = 0;
+    bool settling = params.direction == AngularDirection::AUTO;
+    pros::MotorGroup* locked = lockedSide == DriveSide::LEFT ? drivetrain.leftMotors : drivetrain.rightMotors;
+    pros::MotorGroup* swinging = lockedSide == DriveSide::LEFT ? drivetrain.rightMotors : drivetrain.leftMotors;
+    // the swinging side drives backwards for a clockwise turn about the left wheels
+    const float direction = lockedSide == DriveSide::LEFT ? -1 : 1;
+    Timer timer(timeout);
+    while (!timer.isDone() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled += std::fabs(wrap180(pose.theta - prevTheta));
+        prevTheta = pose.theta;
+        if (!settling && std::fabs(wrap180(theta - pose.theta)) < 20) settling = true;
+        const float error = directedError(theta, pose.theta, settling ? AngularDirection::AUTO : params.direction);
+        if (std::fabs(error) < angularSettings.largeError) sim::report().motionNear(record);
+        if (params.minSpeed != 0 && std::fabs(error) < params.earlyExitRange) {
+            exit = "early exit";
+            break;
+        }
+        angularLargeExit.update(error);
+        angularSmallExit.update(error);
+        if (angularLargeExit.getExit() || angularSmallExit.getExit()) {
+            exit = "settled";
+            break;
+        }
+        float output = angularPID.update(error);
+        output = std::clamp(output, -params.maxSpeed, params.maxSpeed);
+        output = slew(output, prevOutput, angularSettings.slew);
+        if (!settling && std::fabs(output) < params.minSpeed) output = sgn(output) * params.minSpeed;
+        prevOutput = output;
+        locked->move_velocity(0);
+        swinging->move(output * direction);
+        pros::delay(10);
+    }
+    if (!motionRunning) exit = "cancelled";
+    if (params.minSpeed == 0) {
+        drivetrain.leftMotors->move(0);
+        drivetrain.rightMotors->move(0);
+    }
+    distTraveled = -1;
+    sim::report().motionEnded(record, exit);
+    endMotion();
+}
+
+void Chassis::swingToPoint(float x, float y, DriveSide lockedSide, int timeout, SwingToPointParams params,
+                           bool async) {
+    const float theta = headingTo(getPose(), Pose(x, y)) + (params.forwards ? 0 : 180);
+    swingToHeading(theta, lockedSide, timeout,
+                   {.direction = params.direction,
+                    .maxSpeed = params.maxSpeed,
+                    .minSpeed = params.minSpeed,
+                    .earlyExitRange = params.earlyExitRange},
+                   async);
+}
+
+void Chassis::moveToPoint(float x, float y, int timeout, MoveToPointParams params, bool async) {
+    sim::Scope scope("motion");
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { moveToPoint(x, y, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    const int record = sim::report().motionStarted(describe("moveToPoint(%.1f, %.1f)", x, y));
+    const char* exit = "timeout";
+    lateralPID.reset();
+    lateralLargeExit.reset();
+    lateralSmallExit.reset();
+    angularPID.reset();
+    const Pose target(x, y);
+    Pose lastPose = getPose();
+    // the motion-chaining exit line is perpendicular to the initial approach
+    const float approach = degToRad(headingTo(lastPose, target));
+    distTraveled = 0;
+    bool close = false;
+    float prevLateralOut = 0;
+    Timer timer(timeout);
+    while (!timer.isDone() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+        const float distance = pose.distance(target);
+        if (distance < lateralSettings.largeError) sim::report().motionNear(record);
+        if (distance < 7.5 && !close) {
+            close = true;
+            params.maxSpeed = std::max(std::fabs(prevLateralOut), 60.0f);
+        }
+        const float remaining = (target.x - pose.x) * std::sin(approach) + (target.y - pose.y) * std::cos(approach);
+        if (params.minSpeed != 0 && remaining < params.earlyExitRange) {
+            exit = "early exit";
+            break;
+        }
+        const float robotHeading = params.forwards ? pose.theta : pose.theta + 180;
+        const float angularError = wrap180(headingTo(pose, target) - robotHeading);
+        const float lateralError = distance * std::cos(degToRad(wrap180(headingTo(pose, target) - pose.theta)));
+        lateralSmallExit.update(lateralError);
+        lateralLargeExit.update(lateralError);
+        if (close && (lateralSmallExit.getExit() || lateralLargeExit.getExit())) {
+            exit = "settled";
+            break;
+        }
+        float lateralOut = lateralPID.update(lateralError);
+        float angularOut = close ? 0 : angularPID.update(angularError);
+        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
+        if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
+        if (params.forwards && !close) lateralOut = std::max(lateralOut, params.minSpeed);
+        else if (!params.forwards && !close) lateralOut = std::min(lateralOut, -params.minSpeed);
+        prevLateralOut = lateralOut;
+        const float ratio =
+            std::max(std::fabs(lateralOut + angularOut), std::fabs(lateralOut - angularOut)) / params.maxSpeed;
+        if (ratio > 1) {
+            lateralOut /= ratio;
+            angularOut /= ratio;
+        }
+        drivetrain.leftMotors->move(lateralOut + angularOut);
+        drivetrain.rightMotors->move(lateralOut - angularOut);
+        pros::delay(10);
+    }
+    if (!motionRunning) exit = "cancelled";
+    if (params.minSpeed == 0) {
+        drivetrain.leftMotors->move(0);
+        drivetrain.rightMotors->move(0);
+    }
+    distTraveled = -1;
+    sim::report().motionEnded(record, exit);
+    endMotion();
+}
+
+void Chassis::moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params, bool async) {
+    sim::Scope scope("motion");
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this]() { moveToPose(x, y, theta, timeout, params, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    const int record = sim::report().motionStarted(describe("moveToPose(%.1f, %.1f, %.1f)", x, y, theta));
+    const char* exit = "timeout";
+    lateralPID.reset();
+    lateralLargeExit.reset();
+    lateralSmallExit.reset();
+    angularPID.reset();
+    const Pose target(x, y, theta);
+    const float targetHeading = degToRad(params.forwards ? theta : theta + 180);
+    Pose lastPose = getPose();
+    distTraveled = 0;
+    bool close = false;
+    float prevLateralOut = 0;
+    Timer timer(timeout);
+    while (!timer.isDone() && motionRunning) {
+        const Pose pose = getPose();
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+        const float distance = pose.distance(target);
+        if (distance < lateralSettings.largeError) sim::report().motionNear(record);
+        if (distance < 7.5 && !close) {
+            close = true;
+            params.maxSpeed = std::max(std::fabs(prevLateralOut), 60.0f);
+        }
+        // boomerang: chase a carrot point behind the target along its heading
+        const Pose carrot = close ? target
+                                  : target - Pose(std::sin(targetHeading), std::cos(targetHeading)) *
+                                                 (params.lead * distance);
+        const float robotHeading = params.forwards ? pose.theta : pose.theta + 180;
+        const float angularError =
+            close ? wrap180(theta - pose.theta) : wrap180(headingTo(pose, carrot) - robotHeading);
+        const float lateralError = distance * std::cos(degToRad(wrap180(headingTo(pose, carrot) - pose.theta)));
+        lateralSmallExit.update(lateralError);
+        lateralLargeExit.update(lateralError);
+        if (close && (lateralSmallExit.getExit() || lateralLargeExit.getExit())) {
+            exit = "settled";
+            break;
+        }
+        if (params.minSpeed != 0 && distance < params.earlyExitRange) {
+            exit = "early exit";
+            break;
+        }
+        float lateralOut = lateralPID.update(lateralError);
+        float angularOut = angularPID.update(angularError);
+        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
+        if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
+        if (params.forwards && !close) lateralOut = std::max(lateralOut, params.minSpeed);
+        else if (!params.forwards && !close) lateralOut = std::min(lateralOut, -params.minSpeed);
+        prevLateralOut = lateralOut;
+        const float ratio =
+            std::max(std::fabs(lateralOut + angularOut), std::fabs(lateralOut - angularOut)) / params.maxSpeed;
+        if (ratio > 1) {
+            lateralOut /= ratio;
+            angularOut /= ratio;
+        }
+        drivetrain.leftMotors->move(lateralOut + angularOut);
+        drivetrain.rightMotors->move(lateralOut - angularOut);
+        pros::delay(10);
+    }
+    if (!motionRunning) exit = "cancelled";
+    if (params.minSpeed == 0) {
+        drivetrain.leftMotors->move(0);
+        drivetrain.rightMotors->move(0);
+    }
+    distTraveled = -1;
+    sim::report().motionEnded(record, exit);
+    endMotion();
+}
+
+void Chassis::follow(const asset& path, float lookahead, int timeout, bool forwards, bool async) {
+    sim::Scope scope("motion");
+    requestMotionStart();
+    if (!motionRunning) return;
+    if (async) {
+        pros::Task task([=, this, &path]() { follow(path, lookahead, timeout, forwards, false); });
+        endMotion();
+        pros::delay(10);
+        return;
+    }
+    const int record = sim::report().motionStarted(describe("follow(%.0f points, lookahead %.0f)",
+                                                            float(readPath(path).size()), lookahead));
+    const char* exit = "timeout";
+    const std::vector<Pose> points = readPath(path);
+    if (points.size() < 2) {
+        sim::report().motionEnded(record, "empty path");
+        distTraveled = -1;
+        endMotion();
+        return;
+    }
+    Pose lastPose = getPose();
+    Pose lastLookahead = points.front();
+    lastLookahead.theta = 0;
+    float prevVelocity = 0;
+    distTraveled = 0;
+    Timer timer(timeout);
+    while (!timer.isDone() && motionRunning) {
+        Pose pose = getPose();
+        if (!forwards) pose.theta += 180;
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+
+        // closest waypoint, searching the whole path every cycle
+        int closest = 0;
+        for (int i = 1; i < int(points.size()); i++) {
+            if (pose.distance(points[i]) < pose.distance(points[closest])) closest = i;
+        }
+        if (pose.distance(points.back()) < lateralSettings.largeError) sim::report().motionNear(record);
+        // the last points of a path.jerryio export have zero speed
+        if (points[closest].theta == 0) {
+            exit = "settled";
+            break;
+        }
+
+        // lookahead point: first intersection at or after the closest point and the last lookahead
+        Pose target = lastLookahead;
+        for (int i = std::max(closest, int(lastLookahead.theta)); i < int(points.size()) - 1; i++) {
+            const float t = circleIntersect(points[i], points[i + 1], pose, lookahead);
+            if (t != -1) {
+                target = points[i].lerp(points[i + 1], t);
+                target.theta = i;
+                break;
+            }
+        }
+        lastLookahead = target;
+
+        // curvature of the arc to the lookahead point, positive to the right
+        const float heading = degToRad(pose.theta);
+        const float dx = target.x - pose.x;
+        const float dy = target.y - pose.y;
+        const float lateral = dx * std::cos(heading) - dy * std::sin(heading);
+        const float distanceSquared = dx * dx + dy * dy;
+        const float curvature = distanceSquared == 0 ? 0 : 2 * lateral / distanceSquared;
+
+        float velocity = slew(points[closest].theta, prevVelocity, lateralSettings.slew);
+        prevVelocity = velocity;
+        float left = velocity * (2 + curvature * drivetrain.trackWidth) / 2;
+        float right = velocity * (2 - curvature * drivetrain.trackWidth) / 2;
+        const float ratio = std::max(std::fabs(left), std::fabs(right)) / 127;
+        if (ratio > 1) {
+            left /= ratio;
+            right /= ratio;
+        }
+        if (forwards) {
+            drivetrain.leftMotors->move(left);
+            drivetrain.rightMotors->move(right);
+        } else {
+            drivetrain.leftMotors->move(-right);
+            drivetrain.rightMotors->move(-left);
+        }
+        pros::delay(10);
+    }
+    if (!motionRunning) exit = "cancelled";
+    drivetrain.leftMotors->move(0);
+    drivetrain.rightMotors->move(0);
+    distTraveled = -1;
+    sim::report().motionEnded(record, exit);
+    endMotion();
+}
+
+void Chassis::tank(int left, int right, bool disableDriveCurve) {
+    if (!disableDriveCurve) {
+        left = throttleCurve->curve(left);
+        right = throttleCurve->curve(right);
+    }
+    drivetrain.leftMotors->move(left);
+    drivetrain.rightMotors->move(right);
+}
+
+void Chassis::arcade(int throttle, int turn, bool disableDriveCurve, float desaturateBias) {
+    if (!disableDriveCurve) {
+        throttle = throttleCurve->curve(throttle);
+        turn = steerCurve->curve(turn);
+    }
+    float leftPower = throttle + turn;
+    float rightPower = throttle - turn;
+    // desaturate, keeping desaturateBias of the turn and the rest of the throttle
+    if (std::fabs(throttle) + std::fabs(turn) > 127) {
+        const float oldThrottle = throttle;
+        const float oldTurn = turn;
+        float newThrottle = oldThrottle * (1 - desaturateBias * std::fabs(oldTurn / 127.0f));
+        float newTurn = oldTurn * (1 - (1 - desaturateBias) * std::fabs(oldThrottle / 127.0f));
+        const float sum = std::fabs(newThrottle) + std::fabs(newTurn);
+        if (sum > 127) {
+            newThrottle = newThrottle / sum * 127;
+            newTurn = newTurn / sum * 127;
+        }
+        leftPower = newThrottle + newTurn;
+        rightPower = newThrottle - newTurn;
+    }
+    drivetrain.leftMotors->move(leftPower);
+    drivetrain.rightMotors->move(rightPower);
+}
+
+void Chassis::curvature(int throttle, int turn, bool disableDriveCurve) {
+    if (throttle == 0) return arcade(throttle, turn, disableDriveCurve);
+    if (!disableDriveCurve) {
+        throttle = throttleCurve->curve(throttle);
+        turn = steerCurve->curve(turn);
+    }
+    float leftPower = throttle + (std::fabs(throttle) * turn) / 127.0;
+    float rightPower = throttle - (std::fabs(throttle) * turn) / 127.0;
+    const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127.0;
+    if (ratio > 1) {
+        leftPower /= ratio;
+        rightPower /= ratio;
+    }
+    drivetrain.leftMotors->move(leftPower);
+    drivetrain.rightMotors->move(rightPower);
+}
+} // namespace lemlib
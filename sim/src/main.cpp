@@ -0,0 +1,140 @@
+// autosim: run an autonomous routine against the simulated robot and print
+// how long it and each of its motions took.
+//
+//     ./bin/autosim skills
+//     ./bin/autosim skills --check golden.txt    exit 3 if slower than the golden numbers
+//     ./bin/autosim skills --update golden.txt   record this run as the golden numbers
+//     ./bin/autosim skills --log /tmp            write the flight log into /tmp instead of /usd
+//     ./bin/autosim characterize --log /tmp      drive feedforward tests into /tmp/characterize.csv
+//     ./bin/autosim skills --drift --gps         miscalibrated odometry sensors, with the GPS plugged in (EKF=1)
+//     ./bin/autosim skills --hold 60000          keep sampling odometry drift until 60 s after the start
+#include "main.h"
+#include "auto.h"
+#include "config.hpp"
+#include "flightlog.hpp"
+#include "sim/kernel.hpp"
+#include "sim/model.hpp"
+#include "sim/report.hpp"
+#include "sim/world.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+struct Routine {
+        const char* name;
+        AutonomousMode mode;
+};
+
+constexpr Routine ROUTINES[] = {
+    {"skills", AutonomousMode::SKILLS},       {"red_ring", AutonomousMode::RED_RING},
+    {"red_stake", AutonomousMode::RED_STAKE}, {"blue_ring", AutonomousMode::BLUE_RING},
+    {"blue_stake", AutonomousMode::BLUE_STAKE}, {"test", AutonomousMode::TEST},
+    {"characterize", AutonomousMode::CHARACTERIZE},
+};
+
+// a skills run is 60 s and a match autonomous 15 s; leave room to see overruns
+constexpr std::uint32_t DEFAULT_LIMIT = 120000; // ms
+
+// compare the robot's pose with the true one while the routine runs
+void sampleDrift() {
+    pros::Task task([]() {
+        while (true) {
+            if (sim::world().autonomous) {
+                const lemlib::Pose estimate = lemlib::getPose();
+                const sim::Pose& truth = sim::world().pose;
+                sim::report().sampleDrift(std::hypot(estimate.x - truth.x, estimate.y - truth.y),
+                                          std::fabs(std::remainder(estimate.theta - truth.theta, 360.0)));
+            }
+            pros::delay(10);
+        }
+    }, "Drift");
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: autosim <routine> [--limit ms] [--check golden] [--update golden] [--log dir] [--drift] [--gps] [--hold ms]\nroutines:");
+    for (const Routine& routine : ROUTINES) std::fprintf(stderr, " %s", routine.name);
+    std::fprintf(stderr, "\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    const Routine* routine = nullptr;
+    for (const Routine& candidate : ROUTINES) {
+        if (std::strcmp(candidate.name, argv[1]) == 0) routine = &candidate;
+    }
+    if (routine == nullptr) {
+        usage();
+        return 2;
+    }
+    current_auto = routine->mode;
+
+    sim::Report& report = sim::report();
+    report.mirrored = mirrored_frame(routine->mode);
+    report.limit = DEFAULT_LIMIT;
+    const char* check = nullptr;
+    const char* update = nullptr;
+    std::uint32_t hold = 0;
+    sim::ModelOptions options;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--drift") == 0) options.drift = true;
+        else if (std::strcmp(argv[i], "--gps") == 0) options.gps = true;
+        else if (i + 1 == argc) {
+            usage();
+            return 2;
+        } else if (std::strcmp(argv[i], "--limit") == 0) report.limit = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--check") == 0) check = argv[++i];
+        else if (std::strcmp(argv[i], "--update") == 0) update = argv[++i];
+        else if (std::strcmp(argv[i], "--log") == 0) robot::flightLog.setDirectory(argv[++i]);
+        else if (std::strcmp(argv[i], "--hold") == 0) hold = std::atoi(argv[++i]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    sim::attachModel(options);
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    report.finished = sim::run(
+        [&report, &options, hold]() {
+            initialize();
+            // constants::GPS_FUSION stays off until the sensor is on the robot
+            if (options.gps && robot::constants::EKF_ODOMETRY) {
+                robot::drivetrain::odometry.setGps(&robot::drivetrain::gps, robot::drivetrain::gpsSettings);
+            }
+            if (!report.mirrored) sampleDrift();
+            report.start = pros::millis();
+            report.track();
+            sim::world().autonomous = true;
+            autonomous();
+            // async motions may still be running when autonomous() returns
+            {
+                sim::Scope scope("trailing motion");
+                while (robot::drivetrain::chassis.isInMotion()) pros::delay(10);
+            }
+            report.end = pros::millis();
+            // the robot sits still, but the IMU keeps drifting
+            while (pros::millis() - report.start < hold) pros::delay(10);
+            sim::world().autonomous = false;
+            disabled();
+            // let the helper tasks see the mode change and wind down
+            pros::delay(50);
+        },
+        report.limit);
+    if (!report.finished) report.end = pros::millis();
+    const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+
+    report.print(routine->name, wall.count());
+    const robot::CommandCache::Counters& writes = robot::CommandCache::counters();
+    std::printf("device writes: %u forwarded (%u refreshes), %u dropped by the command cache\n", writes.forwarded,
+                writes.refreshed, writes.suppressed);
+    if (update != nullptr) report.update(routine->name, update);
+    if (check != nullptr && !report.check(routine->name, check)) return 3;
+    return report.finished ? 0 : 1;
+}
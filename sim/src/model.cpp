@@ -0,0 +1,150 @@
+#include "sim/model.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+
+namespace sim {
+namespace {
+// src/config.cpp
+constexpr int VERTICAL_ROTATION_PORT = 1;
+constexpr double VERTICAL_WHEEL_DIAMETER = 2.125;
+constexpr int LB_MOTOR_PORT = 10;
+constexpr int LB_ROTATION_PORT = 15;
+// the LB hangs straight down at 0 and is level at 9000 centidegrees, where gravity costs it this much speed
+constexpr double LB_HORIZONTAL = 9000;
+constexpr double LB_GRAVITY = 25; // rpm
+constexpr int DRIVE_PORTS[] = {18, 20, 19, 12, 13, 14};
+// distance sensors: port, right and forward of the centre (in), facing (deg clockwise from the front)
+struct DistanceMount {
+    int port;
+    double x;
+    double y;
+    double angle;
+};
+constexpr DistanceMount DISTANCE_MOUNTS[] = {{2, 0, 6, 0}, {3, -6, 0, 270}, {4, 6, 0, 90}};
+constexpr double DISTANCE_RANGE = 2000; // mm
+
+// a loaded drivetrain responds slower than a free spinning motor
+constexpr double DRIVE_TAU = 0.12;
+
+// ModelOptions::drift
+constexpr double DRIFT_WHEEL_SCALE = 1.01;
+constexpr double DRIFT_IMU_SCALE = 1.005;
+constexpr double DRIFT_IMU_BIAS = 1.0 / 60; // deg/s
+
+// millimetres from a mounted sensor along its beam to the nearest field wall
+double castToWall(const Pose& pose, const DistanceMount& mount) {
+    const double heading = pose.theta * M_PI / 180;
+    const double x = pose.x + mount.x * std::cos(heading) + mount.y * std::sin(heading);
+    const double y = pose.y - mount.x * std::sin(heading) + mount.y * std::cos(heading);
+    const double beam = heading + mount.angle * M_PI / 180;
+    const double dx = std::sin(beam);
+    const double dy = std::cos(beam);
+    const double wall = World::FIELD_HALF_WIDTH;
+    double distance = INFINITY;
+    if (std::abs(dx) > 1e-9) distance = std::min(distance, (std::copysign(wall, dx) - x) / dx);
+    if (std::abs(dy) > 1e-9) distance = std::min(distance, (std::copysign(wall, dy) - y) / dy);
+    const double millimetres = distance * 25.4;
+    return millimetres > DISTANCE_RANGE ? 9999 : millimetres;
+}
+
+// A GPS sensor: a new reading every 20 ms of where the robot was 30 ms earlier, with noise. Now and then it
+// loses sight of the field strip for a while and reports garbage with a large error, as it does when
+// facing a wall it can't read past.
+class GpsModel {
+    public:
+        explicit GpsModel(World& world) : world(world) {}
+
+        // keep the recent poses, every 5 ms
+        void record() {
+            if (!history.empty() && world.time - history.back().first < 0.005) return;
+            history.emplace_back(world.time, world.pose);
+            while (history.size() > 1 && world.time - history.front().first > 0.5) history.pop_front();
+        }
+
+        GpsReading read() {
+            const long slot = std::lround(std::floor(world.time / PERIOD));
+            if (slot == lastSlot) return reading;
+            lastSlot = slot;
+
+            if (world.time >= nextDropoutCheck) {
+                nextDropoutCheck += 1;
+                if (uniform(random) < DROPOUT_CHANCE) {
+                    dropoutStart = world.time + uniform(random) * 0.5;
+                    dropoutEnd = dropoutStart + 0.3 + uniform(random) * 0.6;
+                }
+            }
+            if (world.time >= dropoutStart && world.time < dropoutEnd) {
+                // a jump somewhere near the last reading, rated as such
+                reading.x += jump(random) * 0.0254;
+                reading.y += jump(random) * 0.0254;
+                reading.error = 0.3 + uniform(random);
+                return reading;
+            }
+
+            Pose seen = world.pose;
+            for (const auto& [time, pose] : history) {
+                seen = pose;
+                if (time >= world.time - LATENCY) break;
+            }
+            reading.x = (seen.x + noise(random)) * 0.0254;
+            reading.y = (seen.y + noise(random)) * 0.0254;
+            reading.heading = std::fmod(std::fmod(seen.theta + headingNoise(random), 360) + 360, 360);
+            reading.error = ERROR;
+            return reading;
+        }
+    private:
+        static constexpr double PERIOD = 0.02; // s
+        static constexpr double LATENCY = 0.03; // s
+        static constexpr double ERROR = 0.012; // m, reported while it sees the strip
+        static constexpr double DROPOUT_CHANCE = 0.25; // of a dropout starting in each second
+
+        World& world;
+        std::deque<std::pair<double, Pose>> history;
+        GpsReading reading;
+        long lastSlot = -1;
+        double nextDropoutCheck = 0;
+        double dropoutStart = 0;
+        double dropoutEnd = 0;
+        std::mt19937 random {42};
+        std::uniform_real_distribution<double> uniform {0, 1};
+        std::normal_distribution<double> noise {0, 0.4}; // in
+        std::normal_distribution<double> headingNoise {0, 0.5}; // deg
+        std::normal_distribution<double> jump {0, 10}; // in
+};
+} // namespace
+
+void attachModel(const ModelOptions& options) {
+    World& world = sim::world();
+    for (int port : DRIVE_PORTS) world.motor(port).tau = DRIVE_TAU;
+
+    // the vertical tracking wheel is mounted reversed (port -1)
+    const double wheelScale = options.drift ? DRIFT_WHEEL_SCALE : 1;
+    world.rotationSource.at(VERTICAL_ROTATION_PORT) = [&world, wheelScale]() {
+        return -world.distance * wheelScale / (M_PI * VERTICAL_WHEEL_DIAMETER) * 36000;
+    };
+    if (options.drift) {
+        world.imuScale = DRIFT_IMU_SCALE;
+        world.imuBias = DRIFT_IMU_BIAS;
+    }
+    // the LB rotation sensor sits on the motor shaft
+    world.rotationSource.at(LB_ROTATION_PORT) = [&world]() { return world.motor(LB_MOTOR_PORT).position * 100; };
+    world.loadSource.at(LB_MOTOR_PORT) = [&world]() {
+        const double angle = (world.motor(LB_MOTOR_PORT).position * 100 - LB_HORIZONTAL) / 100 * M_PI / 180;
+        // resting on its hard stop
+        return world.motor(LB_MOTOR_PORT).position <= 0 ? 0 : LB_GRAVITY * std::cos(angle);
+    };
+    world.motor(LB_MOTOR_PORT).minPosition = 0;
+    // the distance sensors only see the field walls
+    for (const DistanceMount& mount : DISTANCE_MOUNTS) {
+        world.distanceSource.at(mount.port) = [&world, mount]() { return castToWall(world.pose, mount); };
+    }
+    if (options.gps) {
+        static GpsModel gps(world);
+        world.afterStep = []() { gps.record(); };
+        world.gpsSource = []() { return gps.read(); };
+    }
+}
+} // namespace sim
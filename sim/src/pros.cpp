@@ -0,0 +1,489 @@
+#include "sim/kernel.hpp"
+#include "sim/report.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+double freeSpeed(pros::MotorGears gearset) {
+    switch (gearset) {
+        case pros::MotorGears::red: return 100;
+        case pros::MotorGears::blue: return 600;
+        default: return 200;
+    }
+}
+
+double sign(std::int8_t port) { return port < 0 ? -1 : 1; }
+
+sim::MotorState& state(std::int8_t port) { return sim::world().motor(std::abs(port)); }
+
+void command(std::int8_t port, sim::MotorState::Mode mode, double value) {
+    sim::MotorState& motor = state(port);
+    motor.mode = mode;
+    motor.command = value * sign(port);
+    motor.writes++;
+}
+
+double readRotation(std::uint8_t port) {
+    sim::World& world = sim::world();
+    const auto& source = world.rotationSource.at(port);
+    return source ? source() : 0;
+}
+} // namespace
+
+namespace pros {
+// RTOS
+std::uint32_t millis() { return sim::now() / 1000; }
+
+std::uint64_t micros() { return sim::now(); }
+
+void delay(std::uint32_t milliseconds) {
+    sim::report().sleepStarted();
+    sim::sleepUntil(sim::now() + std::uint64_t(milliseconds) * 1000);
+    sim::report().sleepEnded();
+}
+
+Task::Task(void (*function)(void*), void* parameters, const char* name) {
+    start([function, parameters]() { function(parameters); }, name);
+}
+
+Task::Task(void (*function)(void*), void* parameters, std::uint32_t, std::uint16_t, const char* name) {
+    start([function, parameters]() { function(parameters); }, name);
+}
+
+void Task::start(std::function<void()> function, const char* name) { id = sim::spawn(std::move(function), name); }
+
+void Task::delay(std::uint32_t milliseconds) { pros::delay(milliseconds); }
+
+void Task::delay_until(std::uint32_t* const prev_time, std::uint32_t delta) {
+    *prev_time += delta;
+    sim::report().sleepStarted();
+    sim::sleepUntil(std::max<std::uint64_t>(sim::now(), std::uint64_t(*prev_time) * 1000));
+    sim::report().sleepEnded();
+}
+
+// a handle per simulated task, nullptr outside them
+task_t c::task_get_current() { return reinterpret_cast<task_t>(std::intptr_t(sim::currentTask() + 1)); }
+
+bool Mutex::take() { return take(TIMEOUT_MAX); }
+
+bool Mutex::take(std::uint32_t timeout) {
+    const std::uint32_t start = millis();
+    while (locked) {
+        if (timeout != TIMEOUT_MAX && millis() - start >= timeout) return false;
+        pros::delay(1);
+    }
+    locked = true;
+    return true;
+}
+
+bool Mutex::give() {
+    locked = false;
+    return true;
+}
+
+void Mutex::lock() { take(); }
+
+void Mutex::unlock() { give(); }
+
+namespace competition {
+std::uint8_t get_status() { return sim::world().autonomous ? 1 : 0; }
+
+std::uint8_t is_autonomous() { return sim::world().autonomous; }
+
+std::uint8_t is_connected() { return true; }
+
+std::uint8_t is_disabled() { return false; }
+} // namespace competition
+
+// Controller: no driver in the loop
+Controller::Controller(controller_id_e_t id) : id(id) {}
+
+std::int32_t Controller::is_connected() { return 1; }
+
+std::int32_t Controller::get_analog(controller_analog_e_t) { return 0; }
+
+std::int32_t Controller::get_digital(controller_digital_e_t) { return 0; }
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t) { return 0; }
+
+std::int32_t Controller::rumble(const char*) { return 1; }
+
+// Motor
+Motor::Motor(std::int8_t port, MotorGears gearset, MotorUnits) : port(port) {
+    state(port).freeSpeed = freeSpeed(gearset);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const { return Motor::move_voltage(voltage * 12000 / 127); }
+
+std::int32_t Motor::move_velocity(std::int32_t velocity) const {
+    command(port, sim::MotorState::Mode::VELOCITY, velocity);
+    return 1;
+}
+
+std::int32_t Motor::move_voltage(std::int32_t voltage) const {
+    command(port, sim::MotorState::Mode::VOLTAGE, voltage);
+    return 1;
+}
+
+std::int32_t Motor::brake() const { return Motor::move_velocity(0); }
+
+std::int32_t Motor::tare_position(std::uint8_t) const {
+    state(port).position = 0;
+    return 1;
+}
+
+std::int32_t Motor::set_zero_position(double position, std::uint8_t) const {
+    state(port).position -= position * sign(port);
+    return 1;
+}
+
+std::int32_t Motor::set_brake_mode(motor_brake_mode_e_t mode, std::uint8_t) const {
+    state(port).brakeMode = mode;
+    state(port).writes++;
+    return 1;
+}
+
+std::int32_t Motor::set_brake_mode(MotorBrake mode, std::uint8_t index) const {
+    return Motor::set_brake_mode(static_cast<motor_brake_mode_e_t>(mode), index);
+}
+
+std::int32_t Motor::set_brake_mode_all(motor_brake_mode_e_t mode) const { return Motor::set_brake_mode(mode); }
+
+std::int32_t Motor::set_brake_mode_all(MotorBrake mode) const {
+    return Motor::set_brake_mode_all(static_cast<motor_brake_mode_e_t>(mode));
+}
+
+std::int32_t Motor::set_gearing(MotorGears gearset, std::uint8_t) const {
+    state(port).freeSpeed = freeSpeed(gearset);
+    return 1;
+}
+
+double Motor::get_position(std::uint8_t) const { return state(port).position * sign(port); }
+
+double Motor::get_actual_velocity(std::uint8_t) const { return state(port).velocity * sign(port); }
+
+std::int32_t Motor::get_target_velocity(std::uint8_t) const {
+    const sim::MotorState& motor = state(port);
+    return motor.mode == sim::MotorState::Mode::VELOCITY ? motor.command * sign(port) : 0;
+}
+
+std::int32_t Motor::get_current_draw(std::uint8_t) const { return state(port).current; }
+
+std::int32_t Motor::get_voltage(std::uint8_t) const { return state(port).voltage * sign(port); }
+
+double Motor::get_torque(std::uint8_t) const { return state(port).current / 2500 * 2.1 * 100 / state(port).freeSpeed; }
+
+double Motor::get_efficiency(std::uint8_t) const { return 50; }
+
+double Motor::get_temperature(std::uint8_t) const { return 30; }
+
+MotorBrake Motor::get_brake_mode(std::uint8_t) const { return static_cast<MotorBrake>(state(port).brakeMode); }
+
+std::int8_t Motor::get_port(std::uint8_t) const { return port; }
+
+// MotorGroup
+MotorGroup::MotorGroup(std::initializer_list<std::int8_t> ports, MotorGears gearset, MotorUnits)
+    : ports(ports),
+      gearset(gearset) {
+    for (std::int8_t port : this->ports) state(port).freeSpeed = freeSpeed(gearset);
+}
+
+std::int32_t MotorGroup::move(std::int32_t voltage) const { return MotorGroup::move_voltage(voltage * 12000 / 127); }
+
+std::int32_t MotorGroup::move_velocity(std::int32_t velocity) const {
+    for (std::int8_t port : ports) command(port, sim::MotorState::Mode::VELOCITY, velocity);
+    return 1;
+}
+
+std::int32_t MotorGroup::move_voltage(std::int32_t voltage) const {
+    for (std::int8_t port : ports) command(port, sim::MotorState::Mode::VOLTAGE, voltage);
+    return 1;
+}
+
+std::int32_t MotorGroup::brake() const { return MotorGroup::move_velocity(0); }
+
+std::int32_t MotorGroup::tare_position(std::uint8_t index) const {
+    state(ports.at(index)).position = 0;
+    return 1;
+}
+
+std::int32_t MotorGroup::tare_position_all() const {
+    for (std::int8_t port : ports) state(port).position = 0;
+    return 1;
+}
+
+std::int32_t MotorGroup::set_brake_mode(motor_brake_mode_e_t mode, std::uint8_t index) const {
+    state(ports.at(index)).brakeMode = mode;
+    return 1;
+}
+
+std::int32_t MotorGroup::set_brake_mode(MotorBrake mode, std::uint8_t index) const {
+    return MotorGroup::set_brake_mode(static_cast<motor_brake_mode_e_t>(mode), index);
+}
+
+std::int32_t MotorGroup::set_brake_mode_all(motor_brake_mode_e_t mode) const {
+    for (std::int8_t port : ports) {
+        state(port).brakeMode = mode;
+        state(port).writes++;
+    }
+    return 1;
+}
+
+std::int32_t MotorGroup::set_brake_mode_all(MotorBrake mode) const {
+    return MotorGroup::set_brake_mode_all(static_cast<motor_brake_mode_e_t>(mode));
+}
+
+double MotorGroup::get_position(std::uint8_t index) const {
+    const std::int8_t port = ports.at(index);
+    return state(port).position * sign(port);
+}
+
+std::vector<double> MotorGroup::get_position_all() const {
+    std::vector<double> out;
+    for (std::int8_t port : ports) out.push_back(state(port).position * sign(port));
+    return out;
+}
+
+double MotorGroup::get_actual_velocity(std::uint8_t index) const {
+    const std::int8_t port = ports.at(index);
+    return state(port).velocity * sign(port);
+}
+
+std::vector<double> MotorGroup::get_actual_velocity_all() const {
+    std::vector<double> out;
+    for (std::int8_t port : ports) out.push_back(state(port).velocity * sign(port));
+    return out;
+}
+
+std::int32_t MotorGroup::get_current_draw(std::uint8_t index) const { return state(ports.at(index)).current; }
+
+std::vector<std::int32_t> MotorGroup::get_current_draw_all() const {
+    std::vector<std::int32_t> out;
+    for (std::int8_t port : ports) out.push_back(state(port).current);
+    return out;
+}
+
+std::vector<std::int32_t> MotorGroup::get_voltage_all() const {
+    std::vector<std::int32_t> out;
+    for (std::int8_t port : ports) out.push_back(state(port).voltage * sign(port));
+    return out;
+}
+
+MotorGears MotorGroup::get_gearing(std::uint8_t) const { return gearset; }
+
+std::vector<std::int8_t> MotorGroup::get_port_all() const { return ports; }
+
+std::int8_t MotorGroup::size() const { return ports.size(); }
+
+// Three-wire ports
+namespace adi {
+DigitalOut::DigitalOut(std::uint8_t adi_port, bool init_state)
+    : port(std::toupper(adi_port)) {
+    sim::world().adi.at(port - 'A') = init_state;
+}
+
+std::int32_t DigitalOut::set_value(bool value) const {
+    sim::World& world = sim::world();
+    if (world.adi.at(port - 'A') != value) world.adiLog.push_back({pros::millis(), char(port), value});
+    world.adi.at(port - 'A') = value;
+    return 1;
+}
+
+std::uint8_t DigitalOut::get_port() const { return port; }
+
+Encoder::Encoder(std::uint8_t, std::uint8_t, bool) {}
+
+std::int32_t Encoder::get_value() const { return 0; }
+
+std::int32_t Encoder::reset() const { return 1; }
+} // namespace adi
+
+// Rotation
+Rotation::Rotation(std::int8_t port)
+    : port(std::abs(port)),
+      reversed(port < 0) {}
+
+std::int32_t Rotation::reset() { return reset_position(); }
+
+std::int32_t Rotation::reset_position() const {
+    sim::world().rotationOffset.at(port) = readRotation(port);
+    return 1;
+}
+
+std::int32_t Rotation::set_position(std::uint32_t position) const {
+    const double signedPosition = reversed ? -double(position) : double(position);
+    sim::world().rotationOffset.at(port) = readRotation(port) - signedPosition;
+    return 1;
+}
+
+std::int32_t Rotation::get_position() const {
+    const double position = readRotation(port) - sim::world().rotationOffset.at(port);
+    return reversed ? -position : position;
+}
+
+std::int32_t Rotation::get_velocity() const { return 0; }
+
+std::int32_t Rotation::get_angle() const {
+    const std::int32_t angle = get_position() % 36000;
+    return angle < 0 ? angle + 36000 : angle;
+}
+
+std::int32_t Rotation::set_data_rate(std::uint32_t) const { return 1; }
+
+std::uint8_t Rotation::get_port() const { return port; }
+
+// IMU: reads the ground-truth heading
+namespace {
+double imuOffset = 0;
+}
+
+Imu::Imu(std::uint8_t port) : port(port) {}
+
+std::int32_t Imu::reset(bool) const { return 1; }
+
+bool Imu::is_calibrating() const { return false; }
+
+double Imu::get_rotation() const {
+    const sim::World& world = sim::world();
+    return world.pose.theta * world.imuScale + world.imuBias * world.time + imuOffset;
+}
+
+// deg/s about the sensor's axes; z points up, so clockwise reads negative
+imu_gyro_s_t Imu::get_gyro_rate() const {
+    const sim::World& world = sim::world();
+    return {0, 0, -(world.yawRate * world.imuScale + world.imuBias)};
+}
+
+double Imu::get_heading() const {
+    const double heading = std::fmod(get_rotation(), 360);
+    return heading < 0 ? heading + 360 : heading;
+}
+
+std::int32_t Imu::set_heading(double target) const { return set_rotation(target); }
+
+std::int32_t Imu::set_rotation(double target) const {
+    imuOffset = 0;
+    imuOffset = target - get_rotation();
+    return 1;
+}
+
+std::int32_t Imu::tare() const { return set_rotation(0); }
+
+std::int32_t Imu::set_data_rate(std::uint32_t) const { return 1; }
+
+std::uint8_t Imu::get_port() const { return port; }
+
+// Optical
+Optical::Optical(std::uint8_t port) : port(port) {}
+
+double Optical::get_hue() { return sim::world().hue; }
+
+double Optical::get_saturation() { return sim::world().saturation; }
+
+double Optical::get_brightness() { return sim::world().brightness; }
+
+std::int32_t Optical::get_proximity() { return sim::world().proximity; }
+
+c::optical_rgb_s_t Optical::get_rgb() {
+    // HSV -> RGB with the world brightness as value
+    const sim::World& world = sim::world();
+    const double c = world.brightness * world.saturation;
+    const double h = std::fmod(world.hue, 360) / 60;
+    const double x = c * (1 - std::abs(std::fmod(h, 2) - 1));
+    const double m = world.brightness - c;
+    double r = 0, g = 0, b = 0;
+    if (h < 1) r = c, g = x;
+    else if (h < 2) r = x, g = c;
+    else if (h < 3) g = c, b = x;
+    else if (h < 4) g = x, b = c;
+    else if (h < 5) r = x, b = c;
+    else r = c, b = x;
+    return {(r + m) * 255, (g + m) * 255, (b + m) * 255, world.brightness};
+}
+
+std::int32_t Optical::set_led_pwm(std::uint8_t) { return 1; }
+
+std::int32_t Optical::get_led_pwm() { return 100; }
+
+std::int32_t Optical::set_integration_time(double) { return 1; }
+
+std::int32_t Optical::enable_gesture() { return 1; }
+
+std::int32_t Optical::disable_gesture() { return 1; }
+
+double Optical::get_integration_time() { return 100; }
+
+std::uint8_t Optical::get_port() const { return port; }
+
+// GPS: reads its source, which models the latency, noise and dropouts
+Gps::Gps(std::uint8_t port) : port(port) {}
+
+Gps::Gps(std::uint8_t port, double, double) : port(port) {}
+
+double Gps::get_position_x() const {
+    const auto& source = sim::world().gpsSource;
+    return source ? source().x : PROS_ERR_F;
+}
+
+double Gps::get_position_y() const {
+    const auto& source = sim::world().gpsSource;
+    return source ? source().y : PROS_ERR_F;
+}
+
+double Gps::get_heading() const {
+    const auto& source = sim::world().gpsSource;
+    return source ? source().heading : PROS_ERR_F;
+}
+
+double Gps::get_error() const {
+    const auto& source = sim::world().gpsSource;
+    return source ? source().error : PROS_ERR_F;
+}
+
+std::int32_t Gps::set_data_rate(std::uint32_t) const { return 1; }
+
+std::uint8_t Gps::get_port() const { return port; }
+
+// Distance
+Distance::Distance(std::uint8_t port) : port(port) {}
+
+std::int32_t Distance::get() {
+    const auto& source = sim::world().distanceSource.at(port);
+    return source ? std::int32_t(std::lround(source())) : PROS_ERR;
+}
+
+std::int32_t Distance::get_distance() { return get(); }
+
+std::int32_t Distance::get_confidence() { return sim::world().distanceSource.at(port) ? 63 : 0; }
+
+std::int32_t Distance::get_object_size() { return 0; }
+
+double Distance::get_object_velocity() { return 0; }
+
+std::uint8_t Distance::get_port() const { return port; }
+
+// Brain screen: the report prints the lines as they were at the end
+namespace lcd {
+bool initialize() { return true; }
+
+bool is_initialized() { return true; }
+
+bool clear() {
+    sim::world().screen = {};
+    return true;
+}
+
+bool clear_line(std::int16_t line) { return set_text(line, ""); }
+
+std::uint8_t read_buttons() { return 0; }
+
+bool set_text(std::int16_t line, std::string text) {
+    sim::World& world = sim::world();
+    if (line < 0 || line >= std::int16_t(world.screen.size())) return false;
+    world.screen[line] = std::move(text);
+    return true;
+}
+} // namespace lcd
+} // namespace pros
@@ -0,0 +1,184 @@
+#include "sim/report.hpp"
+#include "sim/kernel.hpp"
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace sim {
+namespace {
+// runs are deterministic; this only absorbs floating point differences between hosts
+constexpr std::uint32_t GOLDEN_TOLERANCE = 25; // ms
+
+std::uint32_t nowMs() { return now() / 1000; }
+
+std::map<std::string, Golden> readGolden(const std::string& path) {
+    std::map<std::string, Golden> golden;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string routine;
+        Golden numbers;
+        if (fields >> routine >> numbers.total >> numbers.timeouts) golden[routine] = numbers;
+    }
+    return golden;
+}
+
+int countTimeouts(const std::vector<MotionRecord>& motions) {
+    int count = 0;
+    for (const MotionRecord& motion : motions) count += motion.exit == "timeout";
+    return count;
+}
+} // namespace
+
+std::uint32_t MotionRecord::lost() const {
+    if (exit != "timeout") return 0;
+    return end - (near != 0 ? near : start);
+}
+
+Report& report() {
+    static Report instance;
+    return instance;
+}
+
+int Report::motionStarted(const std::string& name) {
+    motions.push_back({name, nowMs()});
+    return motions.size() - 1;
+}
+
+void Report::motionNear(int handle) {
+    MotionRecord& motion = motions.at(handle);
+    if (motion.near == 0) motion.near = nowMs();
+}
+
+void Report::motionEnded(int handle, const std::string& exit) {
+    MotionRecord& motion = motions.at(handle);
+    motion.end = nowMs();
+    motion.exit = exit;
+}
+
+bool Report::tracked() const { return task != -1 && currentTask() == task; }
+
+void Report::account() {
+    const std::uint64_t time = now();
+    budget[scopes.empty() ? "other" : scopes.back()] += time - mark;
+    mark = time;
+}
+
+void Report::track() {
+    task = currentTask();
+    mark = now();
+    scopes.clear();
+    budget.clear();
+}
+
+void Report::enter(const std::string& category) {
+    if (!tracked()) return;
+    account();
+    scopes.push_back(category);
+}
+
+void Report::leave() {
+    if (!tracked() || scopes.empty()) return;
+    account();
+    scopes.pop_back();
+}
+
+void Report::sleepStarted() {
+    // sleeps inside a motion or a helper call belong to it
+    if (tracked() && scopes.empty()) enter("delay");
+}
+
+void Report::sleepEnded() {
+    if (tracked() && scopes.size() == 1 && scopes.back() == "delay") leave();
+}
+
+void Report::sampleDrift(double position, double heading) {
+    drift = position;
+    headingDrift = heading;
+    maxDrift = std::max(maxDrift, position);
+    maxHeadingDrift = std::max(maxHeadingDrift, heading);
+}
+
+void Report::print(const std::string& routine, double wallSeconds) const {
+    const double total = (end - start) / 1000.0;
+    std::printf("routine %s: %.2f s", routine.c_str(), total);
+    if (!finished) std::printf(" (stopped at the %.0f s limit)", limit / 1000.0);
+    std::printf(", simulated in %.3f s (%.0fx real time, %llu context switches)\n", wallSeconds,
+                wallSeconds > 0 ? total / wallSeconds : 0.0, static_cast<unsigned long long>(switches()));
+
+    std::printf("%4s %8s %8s %8s  %-44s %s\n", "#", "start", "time", "lost", "motion", "exit");
+    std::uint32_t lost = 0;
+    for (std::size_t i = 0; i < motions.size(); i++) {
+        const MotionRecord& motion = motions[i];
+        const std::uint32_t motionEnd = motion.exit == "running" ? end : motion.end;
+        lost += motion.lost();
+        std::printf("%4zu %8.2f %8.2f %8.2f  %-44s %s\n", i + 1, (motion.start - start) / 1000.0,
+                    (motionEnd - motion.start) / 1000.0, motion.lost() / 1000.0, motion.name.c_str(),
+                    motion.exit.c_str());
+    }
+    for (const AdiEvent& event : world().adiLog) {
+        if (event.time < start) continue;
+        std::printf("     %8.2f           adi %c -> %d\n", (event.time - start) / 1000.0, event.port, event.value);
+    }
+
+    std::printf("time budget of the autonomous task:\n");
+    std::uint64_t accounted = 0;
+    for (const auto& [category, time] : budget) accounted += time;
+    for (const auto& [category, time] : budget) {
+        std::printf("  %-20s %8.2f s %5.1f%%\n", category.c_str(), time / 1e6,
+                    accounted > 0 ? 100.0 * time / accounted : 0.0);
+    }
+    std::printf("  %d motions timed out instead of settling, %.2f s lost to them\n", countTimeouts(motions),
+                lost / 1000.0);
+    // time the drive spent waiting on the routine between motions, what running steps side by side saves
+    std::uint32_t idle = 0;
+    std::uint32_t previousEnd = start;
+    for (const MotionRecord& motion : motions) {
+        if (motion.start > previousEnd) idle += motion.start - previousEnd;
+        previousEnd = std::max(previousEnd, motion.exit == "running" ? end : motion.end);
+    }
+    std::printf("  drive idle between motions: %.2f s\n", idle / 1000.0);
+    if (mirrored) {
+        std::printf("odometry drift: n/a, the routine drives in a mirrored copy of the field\n");
+    } else {
+        std::printf("odometry drift: %.2f in, %.2f deg at the end (at most %.2f in, %.2f deg)\n", drift, headingDrift,
+                    maxDrift, maxHeadingDrift);
+    }
+
+    std::printf("brain screen:\n");
+    for (std::size_t line = 0; line < world().screen.size(); line++) {
+        if (!world().screen[line].empty()) std::printf("  %zu: %s\n", line, world().screen[line].c_str());
+    }
+}
+
+bool Report::check(const std::string& routine, const std::string& path) const {
+    const auto golden = readGolden(path);
+    const auto entry = golden.find(routine);
+    if (entry == golden.end()) {
+        std::printf("golden: no entry for %s in %s\n", routine.c_str(), path.c_str());
+        return true;
+    }
+    const std::uint32_t total = end - start;
+    const int timeouts = countTimeouts(motions);
+    const Golden& expected = entry->second;
+    const bool slower = !finished || total > expected.total + GOLDEN_TOLERANCE;
+    const bool flaky = timeouts > expected.timeouts;
+    std::printf("golden: %s %u ms (%+d ms), %d timeouts (%+d)%s\n", routine.c_str(), total,
+                int(total) - int(expected.total), timeouts, timeouts - expected.timeouts,
+                slower || flaky ? " REGRESSION" : "");
+    return !slower && !flaky;
+}
+
+void Report::update(const std::string& routine, const std::string& path) const {
+    auto golden = readGolden(path);
+    golden[routine] = {end - start, countTimeouts(motions)};
+    std::ofstream file(path);
+    file << "# autonomous timing golden numbers: routine, total ms, timed out motions\n";
+    file << "# regenerate with: make -C sim golden\n";
+    for (const auto& [name, numbers] : golden) file << name << ' ' << numbers.total << ' ' << numbers.timeouts << '\n';
+}
+} // namespace sim
@@ -0,0 +1,88 @@
+#include "sim/world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace sim {
+namespace {
+constexpr double STALL_CURRENT = 2500; // mA
+
+double sideVelocity(const std::vector<std::int8_t>& ports, World& world) {
+    if (ports.empty()) return 0;
+    double sum = 0;
+    for (std::int8_t port : ports) {
+        const double velocity = world.motor(std::abs(port)).velocity;
+        sum += port < 0 ? -velocity : velocity;
+    }
+    return sum / ports.size();
+}
+} // namespace
+
+World& world() {
+    static World instance;
+    return instance;
+}
+
+MotorState& World::motor(int port) { return motors.at(std::clamp(port, 0, PORTS - 1)); }
+
+void World::attachDrivetrain(const std::vector<std::int8_t>& left, const std::vector<std::int8_t>& right,
+                             double trackWidth, double wheelDiameter, double rpm) {
+    leftPorts = left;
+    rightPorts = right;
+    this->trackWidth = trackWidth;
+    this->wheelDiameter = wheelDiameter;
+    this->wheelRpm = rpm;
+}
+
+void World::place(const Pose& pose) {
+    if (placed) return;
+    this->pose = pose;
+    placed = true;
+}
+
+void World::step(double dt) {
+    time += dt;
+    for (std::size_t port = 0; port < motors.size(); port++) {
+        MotorState& motor = motors[port];
+        const double load = loadSource[port] ? loadSource[port]() : 0;
+        double target;
+        if (motor.mode == MotorState::Mode::VELOCITY) {
+            // the motor's velocity loop makes up for the load with whatever voltage it has left
+            target = std::clamp(motor.command, -motor.freeSpeed - load, motor.freeSpeed - load);
+            motor.voltage = std::clamp((target + load) / motor.freeSpeed * 12000, -12000.0, 12000.0);
+        } else {
+            motor.voltage = std::clamp(motor.command, -12000.0, 12000.0);
+            target = motor.voltage / 12000 * motor.freeSpeed - load;
+        }
+        // an unpowered motor coasts down slowly unless it is told to brake
+        double tau = motor.tau;
+        if (motor.command == 0 && motor.brakeMode == 0) tau *= 6;
+        motor.velocity += (target - motor.velocity) * std::min(1.0, dt / tau);
+        motor.position += motor.velocity * 6 * dt;
+        if (motor.position < motor.minPosition) {
+            motor.position = motor.minPosition;
+            motor.velocity = std::max(motor.velocity, 0.0);
+        }
+        motor.current = std::min(STALL_CURRENT, std::abs(target - motor.velocity) / motor.freeSpeed * STALL_CURRENT * 2 +
+                                                    std::abs(motor.velocity) / motor.freeSpeed * 300);
+    }
+
+    if (trackWidth == 0 || leftPorts.empty()) return;
+    // motor rpm -> wheel surface speed (in/s)
+    const double scale = wheelRpm / motor(std::abs(leftPorts.front())).freeSpeed * M_PI * wheelDiameter / 60;
+    const double left = sideVelocity(leftPorts, *this) * scale;
+    const double right = sideVelocity(rightPorts, *this) * scale;
+    const double linear = (left + right) / 2;
+    yawRate = (left - right) / trackWidth * 180 / M_PI;
+    const double heading = (pose.theta + yawRate * dt / 2) * M_PI / 180;
+    const double limit = FIELD_HALF_WIDTH - ROBOT_HALF_WIDTH;
+    const double x = std::clamp(pose.x + linear * std::sin(heading) * dt, -limit, limit);
+    const double y = std::clamp(pose.y + linear * std::cos(heading) * dt, -limit, limit);
+    // a robot pinned against a wall only keeps the motion along it
+    distance += std::hypot(x - pose.x, y - pose.y) * (linear < 0 ? -1 : 1);
+    pose.x = x;
+    pose.y = y;
+    pose.theta += yawRate * dt;
+    if (afterStep) afterStep();
+}
+} // namespace sim
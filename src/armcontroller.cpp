@@ -0,0 +1,92 @@
+#include "armcontroller.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace robot {
+    namespace {
+        // the profile's jerk phases last this long, which keeps it close to a trapezoid
+        constexpr float JERK_TIME = 0.02f; // s
+
+        ProfileLimits limits(const ArmSettings& settings, float speed) {
+            return {settings.maxVelocity * speed, settings.maxAcceleration, settings.maxAcceleration / JERK_TIME};
+        }
+    }
+
+    ArmController::ArmController(pros::Motor* motor, pros::Rotation* sensor, ArmSettings settings, ArmGains gains)
+        : motor(motor),
+          sensor(sensor),
+          settings(settings),
+          gains(gains),
+          profile(0, 0, 0, limits(settings, 1)) {}
+
+    void ArmController::moveTo(float target, float speed) {
+        const uint32_t now = pros::millis();
+        const float position = sensor->get_position();
+        if (!moving) {
+            velocity = 0;
+            lastPosition = position;
+            lastTime = now;
+        }
+        start = position;
+        this->target = target;
+        direction = target >= position ? 1 : -1;
+        // carry on from the current velocity if it is already going the right way
+        profile = SCurve(std::fabs(target - position), std::max(direction * velocity, 0.0f), 0,
+                         limits(settings, std::clamp(speed, 0.05f, 1.0f)));
+        moving = true;
+        gaveUp = false;
+        startTime = now;
+        settledSince = 0;
+    }
+
+    void ArmController::update() {
+        if (!moving) return;
+        const uint32_t now = pros::millis();
+        const float position = sensor->get_position();
+        if (now != lastTime) {
+            const float measured = (position - lastPosition) * 1000 / (now - lastTime);
+            // the sensor reads whole centidegrees; smooth the differences a little
+            velocity += (measured - velocity) * 0.5f;
+            lastPosition = position;
+            lastTime = now;
+        }
+
+        const float t = (now - startTime) / 1000.0f;
+        const SCurve::State reference = profile.at(t);
+        const float referencePosition = start + direction * reference.position;
+        const float referenceVelocity = direction * reference.velocity;
+        const float referenceAcceleration = direction * reference.acceleration;
+
+        const bool within =
+            std::fabs(target - position) < settings.tolerance && std::fabs(velocity) < settings.velocityTolerance;
+        if (!within) settledSince = 0;
+        else if (settledSince == 0) settledSince = std::max(now, 1u);
+        const bool settled = within && now - settledSince >= settings.settleTime;
+        // the hard stop holds the arm at rest, there is nothing to settle
+        const bool resting = target == 0 && std::fabs(position) < settings.tolerance;
+        const bool late = t > profile.duration() + settings.timeout / 1000.0f;
+        if (settled || resting || late) {
+            moving = false;
+            gaveUp = late && !settled && !resting;
+            // the rest position is a hard stop, anywhere else the motor holds
+            if (target == 0) motor->move_voltage(0);
+            else motor->move_velocity(0);
+            return;
+        }
+
+        const float angle = (position - settings.horizontal) / 100 * static_cast<float>(M_PI) / 180;
+        float voltage = gains.kG * std::cos(angle) + gains.kV * referenceVelocity +
+                        gains.kA * referenceAcceleration + gains.kP * (referencePosition - position) +
+                        gains.kD * (referenceVelocity - velocity);
+        if (referenceVelocity != 0) voltage += std::copysign(gains.kS, referenceVelocity);
+        motor->move_voltage(std::clamp(voltage, -12000.0f, 12000.0f));
+    }
+
+    void ArmController::stop() { moving = false; }
+
+    bool ArmController::isMoving() { return moving; }
+
+    bool ArmController::timedOut() { return gaveUp; }
+
+    float ArmController::getTarget() { return target; }
+}
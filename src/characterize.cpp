@@ -0,0 +1,82 @@
+#include "characterize.hpp"
+#include "config.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    constexpr uint32_t PERIOD = 10; // ms between samples
+    constexpr uint32_t REST = 1000; // ms stopped between the tests
+
+    struct Test {
+        const char* name;
+        float ramp; // V/s, quasistatic tests
+        float step; // V, dynamic tests
+        uint32_t duration; // ms
+    };
+
+    // slow enough for the acceleration to stay near zero, then sudden enough for it to dominate; the
+    // distances roughly cancel out
+    constexpr Test TESTS[] = {
+        {"quasistatic-forward", 1.5f, 0, 4000},
+        {"quasistatic-backward", -1.5f, 0, 4000},
+        {"dynamic-forward", 0, 6, 1500},
+        {"dynamic-backward", 0, -6, 1500},
+    };
+
+    struct Sample {
+        const char* test;
+        uint32_t time; // ms into the test
+        float voltage; // V
+        float velocity; // in/s
+        float acceleration; // in/s^2
+    };
+
+    void drive(float voltage) {
+        robot::drivetrain::leftMotors.move_voltage(voltage * 1000);
+        robot::drivetrain::rightMotors.move_voltage(voltage * 1000);
+    }
+}
+
+namespace robot {
+    bool characterizeDrive(const char* directory) {
+        std::vector<Sample> samples;
+        samples.reserve(1500);
+        for (const Test& test : TESTS) {
+            pros::lcd::print(0, "characterizing: %s", test.name);
+            const uint32_t start = pros::millis();
+            float velocity = drivetrain::chassis.forwardVelocity();
+            uint32_t last = start;
+            while (pros::millis() - start < test.duration) {
+                const uint32_t time = pros::millis() - start;
+                const float voltage = test.ramp != 0 ? test.ramp * time / 1000 : test.step;
+                drive(voltage);
+                pros::delay(PERIOD);
+                const uint32_t now = pros::millis();
+                const float next = drivetrain::chassis.forwardVelocity();
+                const float acceleration = now == last ? 0 : (next - velocity) / ((now - last) / 1000.0f);
+                samples.push_back({test.name, time, voltage, next, acceleration});
+                velocity = next;
+                last = now;
+            }
+            drive(0);
+            pros::delay(REST);
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s/characterize.csv", directory);
+        FILE* file = std::fopen(name, "w");
+        if (file == nullptr) {
+            pros::lcd::print(0, "characterizing: could not write %s", name);
+            return false;
+        }
+        std::fprintf(file, "test,time,voltage,velocity,acceleration\n");
+        for (const Sample& sample : samples) {
+            std::fprintf(file, "%s,%lu,%.3f,%.3f,%.2f\n", sample.test, (unsigned long)sample.time, sample.voltage,
+                         sample.velocity, sample.acceleration);
+        }
+        std::fclose(file);
+        pros::lcd::print(0, "characterizing: %d samples in %s", (int)samples.size(), name);
+        return true;
+    }
+}
@@ -0,0 +1,973 @@
+#include "chassis.hpp"
+#include "path.hpp"
+#include "lemlib/timer.hpp"
+#include "bench.hpp"
+#include "profile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    constexpr float SPACING = 1; // inches between the samples of a chain's path
+    constexpr float START_ANGLE = 15; // degrees off its path a chain drives off without turning in place first
+    constexpr float STOP_ANGLE = 2.1f; // radians, sharper corners are a stop and a turn in place
+    constexpr uint32_t STALL_TIME = 250; // ms a chain's drive may go without progress before moving on
+    constexpr float STALL_DISTANCE = 0.5f; // inches of progress that count
+    constexpr float CLOSEST_WINDOW = 12; // inches of path searched ahead for the closest waypoint each cycle
+    constexpr float INCHES_PER_METER = 39.37f;
+
+    // point a chain drives through
+    struct Vertex {
+        float x;
+        float y;
+        float cap; // velocity limit on the way to it, in/s
+    };
+
+    // heading from (x0, y0) towards (x1, y1), radians
+    float bearing(float x0, float y0, float x1, float y1) { return std::atan2(x1 - x0, y1 - y0); }
+
+    // Append samples along a straight line to (x, y)
+    void lineTo(std::vector<robot::PathSample>& samples, float x, float y, float cap) {
+        const robot::PathSample from = samples.back();
+        const float length = std::hypot(x - from.x, y - from.y);
+        const int count = std::max(1, (int)std::ceil(length / SPACING));
+        for (int i = 1; i <= count; i++) {
+            const float t = (float)i / count;
+            samples.push_back({from.x + (x - from.x) * t, from.y + (y - from.y) * t, from.distance + length * t, 0, cap});
+        }
+    }
+
+    // Append samples along an arc leaving at heading and turning by angle (radians, positive clockwise)
+    void arcTo(std::vector<robot::PathSample>& samples, float heading, float angle, float radius, float cap) {
+        const robot::PathSample from = samples.back();
+        const float side = angle > 0 ? 1 : -1;
+        // the centre is to the right of the direction of travel when turning clockwise
+        const float centerX = from.x + side * radius * std::cos(heading);
+        const float centerY = from.y - side * radius * std::sin(heading);
+        const float length = radius * std::fabs(angle);
+        const int count = std::max(1, (int)std::ceil(length / SPACING));
+        for (int i = 1; i <= count; i++) {
+            const float t = (float)i / count;
+            const float theta = heading + angle * t;
+            samples.push_back({centerX - side * radius * std::cos(theta), centerY + side * radius * std::sin(theta),
+                               from.distance + length * t, side / radius, cap});
+        }
+    }
+
+    // Samples from (x, y) through the vertices, rounding each corner off with an arc starting up to blend
+    // inches before it
+    std::vector<robot::PathSample> roundCorners(float x, float y, const std::vector<Vertex>& vertices, float blend) {
+        std::vector<robot::PathSample> samples = {{x, y, 0, 0, vertices.front().cap}};
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vertex& corner = vertices[i];
+            if (i + 1 == vertices.size()) {
+                lineTo(samples, corner.x, corner.y, corner.cap);
+                break;
+            }
+            const Vertex& next = vertices[i + 1];
+            const float fromX = i == 0 ? x : vertices[i - 1].x;
+            const float fromY = i == 0 ? y : vertices[i - 1].y;
+            const float in = bearing(fromX, fromY, corner.x, corner.y);
+            const float angle = lemlib::angleError(bearing(corner.x, corner.y, next.x, next.y), in);
+            // each side keeps half of the next segment for the corner at its other end
+            const float cut = std::min({blend, std::hypot(corner.x - fromX, corner.y - fromY) / 2,
+                                        std::hypot(next.x - corner.x, next.y - corner.y) / 2});
+            if (std::fabs(angle) < 0.01f || cut < 0.05f) {
+                lineTo(samples, corner.x, corner.y, corner.cap);
+                continue;
+            }
+            lineTo(samples, corner.x - cut * std::sin(in), corner.y - cut * std::cos(in), corner.cap);
+            arcTo(samples, in, angle, cut / std::tan(std::fabs(angle) / 2), std::min(corner.cap, next.cap));
+        }
+        return samples;
+    }
+
+    // direction of travel through a compiled path's waypoint, radians
+    float heading(const robot::path::PathView& points, int i) {
+        const int from = std::max(i - 1, 0);
+        const int to = std::min(i + 1, points.size() - 1);
+        return bearing(points[from].x, points[from].y, points[to].x, points[to].y);
+    }
+
+    // velocity through a compiled path's waypoint from the planned times, in/s; the path stops at last
+    float velocity(const robot::path::PathView& points, int i, int last) {
+        if (i >= last) return 0;
+        const int from = std::max(i - 1, 0);
+        const int to = std::min(i + 1, last);
+        const float time = points[to].time - points[from].time;
+        return time > 0 ? (points[to].distance - points[from].distance) / time : 0;
+    }
+
+    // where a compiled path's planned profile has the robot at a time
+    struct Reference {
+        float x;
+        float y;
+        float theta; // radians
+        float velocity; // in/s
+        float turn; // rad/s, positive clockwise
+    };
+
+    // The reference t seconds into the profile of the path up to waypoint last. segment is the waypoint the
+    // last call found the robot past; it only moves forward.
+    Reference sample(const robot::path::PathView& points, int last, float t, int& segment) {
+        while (segment < last - 1 && points[segment + 1].time <= t) segment++;
+        const robot::path::Waypoint& from = points[segment];
+        const robot::path::Waypoint& to = points[segment + 1];
+        const float span = to.time - from.time;
+        const float f = span > 0 ? std::clamp((t - from.time) / span, 0.0f, 1.0f) : 1;
+        const float fromHeading = heading(points, segment);
+        const float fromVelocity = velocity(points, segment, last);
+        const float toVelocity = velocity(points, segment + 1, last);
+        Reference reference;
+        reference.x = from.x + (to.x - from.x) * f;
+        reference.y = from.y + (to.y - from.y) * f;
+        reference.theta = fromHeading + lemlib::angleError(heading(points, segment + 1), fromHeading) * f;
+        reference.velocity = fromVelocity + (toVelocity - fromVelocity) * f;
+        reference.turn = reference.velocity * (from.curvature + (to.curvature - from.curvature) * f);
+        return reference;
+    }
+
+    // free speed of a motor cartridge, rpm
+    float cartridgeRpm(pros::MotorGears gears) {
+        switch (gears) {
+            case pros::MotorGears::red: return 100;
+            case pros::MotorGears::green: return 200;
+            default: return 600;
+        }
+    }
+}
+
+namespace robot {
+    Chassis::Chassis(lemlib::Drivetrain drivetrain, lemlib::ControllerSettings linearSettings,
+                     lemlib::ControllerSettings angularSettings, lemlib::OdomSensors sensors, DriveProfile profile,
+                     lemlib::DriveCurve* throttleCurve, lemlib::DriveCurve* steerCurve)
+        : lemlib::Chassis(drivetrain, linearSettings, angularSettings, sensors, throttleCurve, steerCurve),
+          profile(profile) {
+        // LemLib's loops send the drive a command every cycle, so that is where their triggers are checked
+        auto* left = dynamic_cast<CachedMotorGroup*>(drivetrain.leftMotors);
+        if (left != nullptr) left->onCommand([this] { driveCommanded(); });
+    }
+
+    template <typename Motion> void Chassis::start(const Target& next, bool async, Motion motion) {
+        if (async) {
+            pros::Task task([this, next, motion]() { start(next, false, motion); });
+            pros::delay(10); // delay to give the task time to start
+            return;
+        }
+        // LemLib queues the motion and runs its loop on this task
+        Wrapped running = {pros::c::task_get_current(), next};
+        wrappedMutex.take();
+        wrapped.push_back(&running);
+        wrapping = wrapped.size();
+        wrappedMutex.give();
+        motion();
+        wrappedMutex.take();
+        wrapped.erase(std::find(wrapped.begin(), wrapped.end(), &running));
+        wrapping = wrapped.size();
+        wrappedMutex.give();
+        if (running.triggers != 0) finishTriggers(running.triggers);
+    }
+
+    void Chassis::driveCommanded() {
+        if (wrapping == 0) return;
+        const pros::task_t task = pros::c::task_get_current();
+        Wrapped* running = nullptr;
+        wrappedMutex.take();
+        for (Wrapped* motion : wrapped) {
+            if (motion->task == task) running = motion;
+        }
+        wrappedMutex.give();
+        // driver control, or one of the motions here that check their own triggers
+        if (running == nullptr) return;
+        // the first cycle, so the motion has left LemLib's queue
+        if (running->triggers == 0) {
+            setTarget(running->target);
+            running->triggers = beginTriggers();
+        }
+        updateTriggers();
+    }
+
+    void Chassis::setTarget(const Target& next) {
+        targetMutex.take();
+        target = next;
+        targetMutex.give();
+    }
+
+    Chassis::Target Chassis::getTarget() {
+        targetMutex.take();
+        const Target now = target;
+        targetMutex.give();
+        return now;
+    }
+
+    void Chassis::turnToPoint(float x, float y, int timeout, lemlib::TurnToPointParams params, bool async) {
+        start({Target::Kind::FACE, x, y, 0, 0, params.forwards}, async,
+              [=, this] { lemlib::Chassis::turnToPoint(x, y, timeout, params, false); });
+    }
+
+    void Chassis::turnToHeading(float theta, int timeout, lemlib::TurnToHeadingParams params, bool async) {
+        start({Target::Kind::HEADING, 0, 0, theta}, async,
+              [=, this] { lemlib::Chassis::turnToHeading(theta, timeout, params, false); });
+    }
+
+    void Chassis::swingToHeading(float theta, lemlib::DriveSide lockedSide, int timeout,
+                                 lemlib::SwingToHeadingParams params, bool async) {
+        start({Target::Kind::HEADING, 0, 0, theta}, async,
+              [=, this] { lemlib::Chassis::swingToHeading(theta, lockedSide, timeout, params, false); });
+    }
+
+    void Chassis::swingToPoint(float x, float y, lemlib::DriveSide lockedSide, int timeout,
+                               lemlib::SwingToPointParams params, bool async) {
+        start({Target::Kind::FACE, x, y, 0, 0, params.forwards}, async,
+              [=, this] { lemlib::Chassis::swingToPoint(x, y, lockedSide, timeout, params, false); });
+    }
+
+    void Chassis::moveToPose(float x, float y, float theta, int timeout, lemlib::MoveToPoseParams params,
+                             bool async) {
+        start({Target::Kind::POINT, x, y, theta, 0, params.forwards}, async,
+              [=, this] { lemlib::Chassis::moveToPose(x, y, theta, timeout, params, false); });
+    }
+
+    void Chassis::moveToPoint(float x, float y, int timeout, lemlib::MoveToPointParams params, bool async) {
+        start({Target::Kind::POINT, x, y, 0, 0, params.forwards}, async,
+              [=, this] { lemlib::Chassis::moveToPoint(x, y, timeout, params, false); });
+    }
+
+    float Chassis::forwardVelocity() const {
+        const pros::MotorGroup& left = *drivetrain.leftMotors;
+        const pros::MotorGroup& right = *drivetrain.rightMotors;
+        float rpm = 0;
+        for (int i = 0; i < left.size(); i++) rpm += left.get_actual_velocity(i) / (2 * left.size());
+        for (int i = 0; i < right.size(); i++) rpm += right.get_actual_velocity(i) / (2 * right.size());
+        // motor rpm -> wheel rpm -> in/s
+        return rpm / cartridgeRpm(left.get_gearing()) * drivetrain.rpm * M_PI * drivetrain.wheelDiameter / 60;
+    }
+
+    void Chassis::setOdometry(Odometry* odometry) { this->odometry = odometry; }
+
+    void Chassis::setPose(float x, float y, float theta, bool radians) {
+        setPose(lemlib::Pose(x, y, theta), radians);
+    }
+
+    void Chassis::setPose(lemlib::Pose pose, bool radians) {
+        lemlib::Chassis::setPose(pose, radians);
+        if (odometry == nullptr) return;
+        if (radians) pose.theta = lemlib::radToDeg(pose.theta);
+        odometry->setPose(pose);
+    }
+
+    PoseCovariance Chassis::getCovariance() {
+        if (odometry == nullptr) return {};
+        return odometry->getCovariance();
+    }
+
+    float Chassis::feedforward(float velocity, float acceleration) const {
+        float power = profile.kV * velocity + profile.kA * acceleration;
+        if (velocity > 0) power += profile.kS;
+        else if (velocity < 0) power -= profile.kS;
+        return power;
+    }
+
+    void Chassis::profiledMoveToPoint(float x, float y, int timeout, ProfiledMoveParams params, bool async) {
+        BENCH_CALL("motion");
+        requestMotionStart();
+        // were all motions cancelled?
+        if (!motionRunning) return;
+        // if the function is async, run it in a new task
+        if (async) {
+            pros::Task task([=, this]() { profiledMoveToPoint(x, y, timeout, params, false); });
+            endMotion();
+            pros::delay(10); // delay to give the task time to start
+            return;
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "profiledMoveToPoint(%.1f, %.1f)", x, y);
+        BENCH_MOTION(name);
+        setTarget({Target::Kind::POINT, x, y, 0, 0, params.forwards});
+        const int opened = beginTriggers();
+
+        // plan along the straight line from here to the point
+        const lemlib::Pose origin = getPose();
+        const float length = std::hypot(x - origin.x, y - origin.y);
+        const float ux = length > 0 ? (x - origin.x) / length : 0;
+        const float uy = length > 0 ? (y - origin.y) / length : 0;
+        const float direction = params.forwards ? 1 : -1;
+        ProfileLimits limits = profile.limits;
+        if (params.maxVelocity > 0) limits.velocity = std::min(limits.velocity, params.maxVelocity);
+        if (params.maxAcceleration > 0) limits.acceleration = std::min(limits.acceleration, params.maxAcceleration);
+        const SCurve curve(length, direction * forwardVelocity(), params.endVelocity, limits);
+
+        angularPID.reset();
+        lateralSmallExit.reset();
+        lateralLargeExit.reset();
+        distTraveled = 0;
+        const uint32_t start = pros::millis();
+        lemlib::Timer timer(timeout);
+        while (!timer.isDone() && motionRunning) {
+            PROFILE_SCOPE("profiled cycle");
+            const lemlib::Pose pose = getPose();
+            // progress along the line, so sideways drift does not count as distance left
+            const float remaining = (x - pose.x) * ux + (y - pose.y) * uy;
+            distTraveled = length - remaining;
+            updateTriggers();
+            if (std::fabs(remaining) < lateralSettings.largeError) BENCH_MOTION_NEAR();
+            if (params.earlyExitRange > 0 && remaining < params.earlyExitRange) {
+                BENCH_MOTION_EXIT("early exit");
+                break;
+            }
+
+            const float t = (pros::millis() - start) / 1000.0f;
+            const SCurve::State reference = curve.at(t);
+            if (t >= curve.duration()) {
+                // carrying speed into the next motion, or settled on the point
+                if (curve.endVelocity() > 0) break;
+                const bool small = lateralSmallExit.update(remaining);
+                const bool large = lateralLargeExit.update(remaining);
+                if (small || large) break;
+            }
+
+            float lateral = profile.kV * reference.velocity + profile.kA * reference.acceleration +
+                            profile.kP * (reference.position - distTraveled) +
+                            profile.kD * (reference.velocity - direction * forwardVelocity());
+            if (reference.velocity > 0) lateral += profile.kS;
+            lateral *= direction;
+
+            // steer at the point until it is too close for its bearing to mean anything
+            float angular = 0;
+            if (std::fabs(remaining) > 6) angular = angularPID.update(angularError());
+            float leftPower = lateral + angular;
+            float rightPower = lateral - angular;
+            const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+            if (ratio > 1) {
+                leftPower /= ratio;
+                rightPower /= ratio;
+            }
+            drivetrain.leftMotors->move(leftPower);
+            drivetrain.rightMotors->move(rightPower);
+            PROFILE_STOP();
+            pros::delay(10);
+        }
+
+        if (!motionRunning) BENCH_MOTION_EXIT("cancelled");
+        else if (timer.isDone()) BENCH_MOTION_EXIT("timeout");
+        // leave the motors running into the next motion, like moveToPoint with a minSpeed
+        if (curve.endVelocity() == 0 && params.earlyExitRange == 0) {
+            drivetrain.leftMotors->move(0);
+            drivetrain.rightMotors->move(0);
+        }
+        finishTriggers(opened);
+        distTraveled = -1;
+        endMotion();
+    }
+
+    void Chassis::chain(std::vector<ChainStep> steps, int timeout, ChainParams params, bool async) {
+        BENCH_CALL("motion");
+        requestMotionStart();
+        // were all motions cancelled?
+        if (!motionRunning) return;
+        // if the function is async, run it in a new task
+        if (async) {
+            pros::Task task([=, this]() { chain(steps, timeout, params, false); });
+            endMotion();
+            pros::delay(10); // delay to give the task time to start
+            return;
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "chain(%d steps)", (int)steps.size());
+        BENCH_MOTION(name);
+        const auto near = [&] { BENCH_MOTION_NEAR(); };
+        ProfileLimits limits = profile.limits;
+        if (params.maxVelocity > 0) limits.velocity = std::min(limits.velocity, params.maxVelocity);
+        if (params.maxAcceleration > 0) limits.acceleration = std::min(limits.acceleration, params.maxAcceleration);
+        const float lateralAcceleration = params.lateralAcceleration > 0 ? params.lateralAcceleration
+                                                                         : limits.acceleration;
+
+        float traveled = 0;
+        bool running = true;
+        distTraveled = 0;
+        const int opened = beginTriggers();
+        lemlib::Timer timer(timeout);
+        for (size_t i = 0; running && i < steps.size();) {
+            const ChainStep& step = steps[i];
+            if (step.kind == ChainStep::Kind::HEADING || step.kind == ChainStep::Kind::SWING) {
+                running = chainTurn(step, angularSettings.largeError, i + 1 == steps.size(), timer, near);
+                i++;
+                continue;
+            }
+
+            // the points and paths up to the next turn or change of direction, split where a corner is too
+            // sharp to drive through
+            const lemlib::Pose start = getPose();
+            std::vector<Vertex> vertices;
+            float lastX = start.x;
+            float lastY = start.y;
+            float lastHeading = NAN;
+            size_t next = i;
+            for (; next < steps.size(); next++) {
+                const ChainStep& part = steps[next];
+                if (part.kind != ChainStep::Kind::POINT && part.kind != ChainStep::Kind::PATH) break;
+                if (part.forwards != step.forwards) break;
+                const float cap = part.maxVelocity > 0 ? part.maxVelocity : limits.velocity;
+                std::vector<Vertex> added;
+                if (part.kind == ChainStep::Kind::POINT) added.push_back({part.x, part.y, cap});
+                else if (path::isCompiled(*part.path)) {
+                    const path::PathView view(*part.path);
+                    for (int k = 0; k < view.size(); k++) added.push_back({view[k].x, view[k].y, cap});
+                }
+                bool first = true;
+                bool sharp = false;
+                for (const Vertex& vertex : added) {
+                    if (std::hypot(vertex.x - lastX, vertex.y - lastY) < 0.1f) continue;
+                    const float heading = bearing(lastX, lastY, vertex.x, vertex.y);
+                    // drive up to a sharp corner between steps, then start again from there
+                    if (first && !std::isnan(lastHeading) &&
+                        std::fabs(lemlib::angleError(heading, lastHeading)) > STOP_ANGLE) {
+                        sharp = true;
+                        break;
+                    }
+                    first = false;
+                    vertices.push_back(vertex);
+                    lastX = vertex.x;
+                    lastY = vertex.y;
+                    lastHeading = heading;
+                }
+                if (sharp) break;
+            }
+            if (vertices.empty()) {
+                i = next;
+                continue;
+            }
+
+            // face down the path before driving off if it starts well off the heading
+            const Vertex& aim = *std::find_if(vertices.begin(), vertices.end(), [&](const Vertex& vertex) {
+                return std::hypot(vertex.x - start.x, vertex.y - start.y) >= params.lookahead ||
+                       &vertex == &vertices.back();
+            });
+            float facing = lemlib::radToDeg(bearing(start.x, start.y, aim.x, aim.y));
+            if (!step.forwards) facing += 180;
+            if (std::fabs(lemlib::angleError(facing, start.theta, false)) > START_ANGLE) {
+                running = chainTurn(ChainStep::heading(facing), START_ANGLE, false, timer, near);
+                if (!running) break;
+            }
+
+            const lemlib::Pose pose = getPose();
+            std::vector<PathSample> samples = roundCorners(pose.x, pose.y, vertices, params.blend);
+            const bool last = next == steps.size();
+            const float direction = step.forwards ? 1 : -1;
+            planVelocity(samples, limits, lateralAcceleration, drivetrain.trackWidth,
+                         direction * forwardVelocity(), last ? params.endVelocity : 0);
+            running = chainDrive(samples, step.forwards, limits.acceleration, params.lookahead, last, traveled,
+                                 timer, near);
+            traveled += samples.back().distance;
+            i = next;
+        }
+
+        if (!motionRunning) BENCH_MOTION_EXIT("cancelled");
+        else if (timer.isDone()) BENCH_MOTION_EXIT("timeout");
+        if (params.endVelocity == 0 || !running) {
+            drivetrain.leftMotors->move(0);
+            drivetrain.rightMotors->move(0);
+        }
+        finishTriggers(opened);
+        distTraveled = -1;
+        endMotion();
+    }
+
+    bool Chassis::chainTurn(const ChainStep& step, float tolerance, bool settle, lemlib::Timer& timer,
+                            const std::function<void()>& near) {
+        setTarget({Target::Kind::HEADING, 0, 0, step.theta});
+        angularPID.reset();
+        angularSmallExit.reset();
+        angularLargeExit.reset();
+        pros::MotorGroup* locked = nullptr;
+        pros::MotorGroup* swinging = nullptr;
+        if (step.kind == ChainStep::Kind::SWING) {
+            const bool left = step.lockedSide == lemlib::DriveSide::LEFT;
+            locked = left ? drivetrain.leftMotors : drivetrain.rightMotors;
+            swinging = left ? drivetrain.rightMotors : drivetrain.leftMotors;
+        }
+        while (!timer.isDone() && motionRunning) {
+            updateTriggers();
+            const float error = lemlib::angleError(step.theta, getPose().theta, false);
+            if (settle) {
+                if (std::fabs(error) < angularSettings.largeError) near();
+                const bool small = angularSmallExit.update(error);
+                const bool large = angularLargeExit.update(error);
+                if (small || large) return true;
+            } else if (std::fabs(error) < tolerance) {
+                return true;
+            }
+
+            const float output = std::clamp(angularPID.update(error), -127.0f, 127.0f);
+            if (locked != nullptr) {
+                // the swinging side drives backwards for a clockwise turn about the left wheels
+                locked->move_velocity(0);
+                swinging->move(locked == drivetrain.leftMotors ? -output : output);
+            } else {
+                drivetrain.leftMotors->move(output);
+                drivetrain.rightMotors->move(-output);
+            }
+            pros::delay(10);
+        }
+        return false;
+    }
+
+    bool Chassis::chainDrive(const std::vector<PathSample>& samples, bool forwards, float acceleration,
+                             float lookahead, bool settle, float distanceOffset, lemlib::Timer& timer,
+                             const std::function<void()>& near) {
+        const PathSample& end = samples.back();
+        const PathSample& beforeEnd = samples[samples.size() - 2];
+        const float endHeading = bearing(beforeEnd.x, beforeEnd.y, end.x, end.y);
+        const float direction = forwards ? 1 : -1;
+        // the robot moves well under a lookahead distance per cycle, so the closest point is within two
+        const int window = (int)std::ceil(2 * lookahead / SPACING);
+        const int lastIndex = samples.size() - 1;
+        int closest = 0;
+        float velocity = std::max(direction * forwardVelocity(), 0.0f);
+        float progress = 0; // along the path when the robot last made progress
+        uint32_t progressTime = pros::millis();
+        lateralPID.reset();
+        lateralSmallExit.reset();
+        lateralLargeExit.reset();
+        while (!timer.isDone() && motionRunning) {
+            PROFILE_SCOPE("chain cycle");
+            lemlib::Pose pose = getPose(true);
+            if (!forwards) pose.theta += M_PI;
+
+            float nearest = INFINITY;
+            for (int j = closest, last = std::min(closest + window, lastIndex); j <= last; j++) {
+                const float distance = std::hypot(samples[j].x - pose.x, samples[j].y - pose.y);
+                if (distance < nearest) {
+                    nearest = distance;
+                    closest = j;
+                }
+            }
+            // past the last corner, measure along the final direction so overshooting reads negative
+            float remaining = end.distance - samples[closest].distance;
+            if (closest >= lastIndex - 1) {
+                remaining = (end.x - pose.x) * std::sin(endHeading) + (end.y - pose.y) * std::cos(endHeading);
+            }
+            distTraveled = distanceOffset + end.distance - remaining;
+
+            // first sample a lookahead away, or past the end along the final direction
+            float lookaheadX = end.x;
+            float lookaheadY = end.y;
+            int ahead = closest;
+            while (ahead <= lastIndex &&
+                   std::hypot(samples[ahead].x - pose.x, samples[ahead].y - pose.y) < lookahead) {
+                ahead++;
+            }
+            if (ahead <= lastIndex) {
+                lookaheadX = samples[ahead].x;
+                lookaheadY = samples[ahead].y;
+            } else {
+                const float extra = lookahead - std::hypot(end.x - pose.x, end.y - pose.y);
+                lookaheadX += std::max(extra, 0.0f) * std::sin(endHeading);
+                lookaheadY += std::max(extra, 0.0f) * std::cos(endHeading);
+            }
+            setTarget({Target::Kind::PATH, lookaheadX, lookaheadY, 0, remaining, forwards});
+            updateTriggers();
+
+            if (!settle) {
+                // stopping to turn; the turn takes over before the robot has quite stopped
+                if (remaining < lateralSettings.smallError) return true;
+            } else if (end.velocity > 0) {
+                if (remaining <= 0) return true;
+            } else if (remaining < lateralSettings.largeError) {
+                // close in on the end with the lateral PID, like moveToPoint
+                near();
+                const bool small = lateralSmallExit.update(remaining);
+                const bool large = lateralLargeExit.update(remaining);
+                if (small || large) return true;
+                const float output = direction * std::clamp(lateralPID.update(remaining), -127.0f, 127.0f);
+                drivetrain.leftMotors->move(output);
+                drivetrain.rightMotors->move(output);
+                PROFILE_STOP();
+                pros::delay(10);
+                continue;
+            }
+
+            // pinned against a wall or a field element; the rest of the chain may still get somewhere
+            if (end.distance - remaining > progress + STALL_DISTANCE) {
+                progress = end.distance - remaining;
+                progressTime = pros::millis();
+            } else if (pros::millis() - progressTime > STALL_TIME) {
+                return true;
+            }
+
+            // the planned velocity one sample ahead, so the robot sets off from rest, rising no faster than
+            // the acceleration limit
+            const float planned = samples[std::min(closest + 1, lastIndex)].velocity;
+            const float next = std::min(planned, velocity + acceleration * 0.01f);
+            const float accel = (next - velocity) / 0.01f;
+            velocity = next;
+            const float measured = direction * forwardVelocity();
+
+            // curvature of the arc to the lookahead point, positive to the right
+            const float dx = lookaheadX - pose.x;
+            const float dy = lookaheadY - pose.y;
+            const float side = dx * std::cos(pose.theta) - dy * std::sin(pose.theta);
+            const float distSquared = dx * dx + dy * dy;
+            const float curvature = distSquared == 0 ? 0 : 2 * side / distSquared;
+
+            // each side's feedforward for its share of the turn, plus feedback on the forward velocity
+            auto output = [&](float scale) {
+                const float wheel = velocity * scale;
+                float power = profile.kV * wheel + profile.kA * accel * scale + profile.kD * (velocity - measured);
+                if (wheel > 0) power += profile.kS;
+                else if (wheel < 0) power -= profile.kS;
+                return power;
+            };
+            float leftPower = output(1 + curvature * drivetrain.trackWidth / 2);
+            float rightPower = output(1 - curvature * drivetrain.trackWidth / 2);
+            const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+            if (ratio > 1) {
+                leftPower /= ratio;
+                rightPower /= ratio;
+            }
+            if (forwards) {
+                drivetrain.leftMotors->move(leftPower);
+                drivetrain.rightMotors->move(rightPower);
+            } else {
+                drivetrain.leftMotors->move(-rightPower);
+                drivetrain.rightMotors->move(-leftPower);
+            }
+            PROFILE_STOP();
+            pros::delay(10);
+        }
+        return false;
+    }
+
+    void Chassis::at(float distance, std::function<void()> callback) {
+        addTrigger({Trigger::Kind::DISTANCE, 0, 0, distance, std::move(callback)});
+    }
+
+    void Chassis::whenWithin(float x, float y, float radius, std::function<void()> callback) {
+        addTrigger({Trigger::Kind::WITHIN, x, y, radius, std::move(callback)});
+    }
+
+    void Chassis::onProgress(float fraction, std::function<void()> callback) {
+        addTrigger({Trigger::Kind::PROGRESS, 0, 0, fraction, std::move(callback)});
+    }
+
+    void Chassis::addTrigger(Trigger trigger) {
+        triggerMutex.take();
+        const bool open = triggersOpen;
+        if (open) triggers.push_back(trigger);
+        triggerMutex.give();
+        // the motion it was meant for is already over
+        if (!open) trigger.callback();
+    }
+
+    int Chassis::beginTriggers() {
+        triggerMutex.take();
+        // LemLib hands its queue on before start() gets back from the motion before
+        std::vector<Trigger> left;
+        left.swap(triggers);
+        triggersOpen = true;
+        initialError = -1;
+        const int opened = ++triggersOpened;
+        triggerMutex.give();
+        for (Trigger& trigger : left) runTrigger(std::move(trigger.callback));
+        return opened;
+    }
+
+    void Chassis::updateTriggers() {
+        std::vector<std::function<void()>> due;
+        triggerMutex.take();
+        if (!triggersOpen) {
+            triggerMutex.give();
+            return;
+        }
+        // distance or angle left, for PROGRESS
+        const Target now = getTarget();
+        const bool turning = now.kind == Target::Kind::HEADING || now.kind == Target::Kind::FACE;
+        const float error = turning ? std::fabs(angularError()) : std::max(lateralError(), 0.0f);
+        if (initialError < 0) initialError = error;
+        const lemlib::Pose pose = getPose();
+        for (auto trigger = triggers.begin(); trigger != triggers.end();) {
+            bool reached = false;
+            switch (trigger->kind) {
+                case Trigger::Kind::DISTANCE: reached = distTraveled >= trigger->value; break;
+                case Trigger::Kind::WITHIN:
+                    reached = std::hypot(trigger->x - pose.x, trigger->y - pose.y) <= trigger->value;
+                    break;
+                case Trigger::Kind::PROGRESS:
+                    reached = initialError <= 0 || 1 - error / initialError >= trigger->value;
+                    break;
+            }
+            if (reached) {
+                due.push_back(std::move(trigger->callback));
+                trigger = triggers.erase(trigger);
+            } else {
+                trigger++;
+            }
+        }
+        triggerMutex.give();
+        for (std::function<void()>& callback : due) runTrigger(std::move(callback));
+    }
+
+    void Chassis::finishTriggers(int opened) {
+        triggerMutex.take();
+        if (opened != triggersOpened) {
+            triggerMutex.give();
+            return;
+        }
+        std::vector<Trigger> left;
+        left.swap(triggers);
+        triggersOpen = false;
+        triggerMutex.give();
+        for (Trigger& trigger : left) runTrigger(std::move(trigger.callback));
+    }
+
+    void Chassis::runTrigger(std::function<void()> callback) {
+        co::Executor* executor = triggerExecutor;
+        if (executor != nullptr) executor->post(std::move(callback));
+        else callback();
+    }
+
+    void Chassis::runTriggersOn(co::Executor* executor) { triggerExecutor = executor; }
+
+    co::Task Chassis::travelled(float distance) {
+        // give the motion a cycle to start, like waitUntil
+        co_await co::tick("waitUntil");
+        co_await co::until([this, distance] { return distTraveled >= distance || distTraveled == -1; }, "waitUntil");
+    }
+
+    co::Task Chassis::done() {
+        co_await co::tick("waitUntilDone");
+        co_await co::until([this] { return distTraveled == -1; }, "waitUntilDone");
+    }
+
+    float Chassis::lateralError() {
+        if (!isInMotion()) return 0;
+        const Target now = getTarget();
+        if (now.kind == Target::Kind::PATH) return now.remaining;
+        if (now.kind != Target::Kind::POINT) return 0;
+        const lemlib::Pose pose = getPose(true);
+        // distance to the target projected on the heading, negative once past it
+        const float dx = now.x - pose.x;
+        const float dy = now.y - pose.y;
+        const float along = dx * std::sin(pose.theta) + dy * std::cos(pose.theta);
+        return now.forwards ? along : -along;
+    }
+
+    float Chassis::angularError() {
+        if (!isInMotion()) return 0;
+        const Target now = getTarget();
+        if (now.kind == Target::Kind::NONE) return 0;
+        const lemlib::Pose pose = getPose();
+        if (now.kind == Target::Kind::HEADING) return lemlib::angleError(now.theta, pose.theta, false);
+        float heading = pose.theta;
+        if (!now.forwards) heading += 180;
+        const float bearing = lemlib::radToDeg(std::atan2(now.x - pose.x, now.y - pose.y));
+        return lemlib::angleError(bearing, heading, false);
+    }
+
+    void Chassis::follow(const asset& path, float lookahead, int timeout, bool forwards, bool async) {
+        follow(path, timeout, {forwards, Tracker::PURE_PURSUIT, lookahead}, async);
+    }
+
+    void Chassis::follow(const asset& path, int timeout, FollowParams params, bool async) {
+        BENCH_CALL("motion");
+        if (!path::isCompiled(path)) {
+            start({}, async, [=, this, &path] {
+                lemlib::Chassis::follow(path, params.lookahead, timeout, params.forwards, false);
+            });
+            return;
+        }
+        requestMotionStart();
+        // were all motions cancelled?
+        if (!motionRunning) return;
+        // if the function is async, run it in a new task
+        if (async) {
+            pros::Task task([=, this, &path]() { follow(path, timeout, params, false); });
+            endMotion();
+            pros::delay(10); // delay to give the task time to start
+            return;
+        }
+
+        path::PathView points(path);
+        const bool ramseteTracker = params.tracker == Tracker::RAMSETE;
+        BENCH_MOTION(ramseteTracker ? "follow(compiled path, ramsete)" : "follow(compiled path)");
+        const auto near = [&] { BENCH_MOTION_NEAR(); };
+        distTraveled = 0;
+        const int opened = beginTriggers();
+        lemlib::Timer timer(timeout);
+        if (ramseteTracker) ramsete(points, params, timer, near);
+        else pursue(points, params.lookahead, params.forwards, timer, near);
+
+        if (!motionRunning) BENCH_MOTION_EXIT("cancelled");
+        else if (timer.isDone()) BENCH_MOTION_EXIT("timeout");
+        drivetrain.leftMotors->move(0);
+        drivetrain.rightMotors->move(0);
+        finishTriggers(opened);
+        distTraveled = -1;
+        endMotion();
+    }
+
+    bool Chassis::pursue(path::PathView& points, float lookahead, bool forwards, lemlib::Timer& timer,
+                         const std::function<void()>& near) {
+        lemlib::Pose lastPose = getPose();
+        lemlib::Pose lookaheadPose(points[0].x, points[0].y);
+        float prevVel = 0;
+        while (!timer.isDone() && motionRunning) {
+            PROFILE_SCOPE("follow cycle");
+            lemlib::Pose pose = getPose();
+            if (!forwards) pose.theta += 180;
+            distTraveled += pose.distance(lastPose);
+            lastPose = pose;
+
+            // the robot moves well under a lookahead distance per cycle, so the closest point is within one
+            const int closest = points.closest(pose.x, pose.y, lookahead);
+            if (std::hypot(points.back().x - pose.x, points.back().y - pose.y) < lateralSettings.largeError) {
+                near();
+            }
+            // path.jerryio ends every path with zero speed waypoints
+            if (points[closest].speed == 0) return true;
+
+            // keep the last lookahead point if the circle no longer reaches the path
+            points.lookahead(pose.x, pose.y, lookahead, closest, lookaheadPose.x, lookaheadPose.y);
+            setTarget({Target::Kind::PATH, lookaheadPose.x, lookaheadPose.y, 0,
+                       points.length() - points[closest].distance, forwards});
+            updateTriggers();
+
+            // curvature of the arc to the lookahead point, positive to the right
+            const float heading = lemlib::degToRad(pose.theta);
+            const float dx = lookaheadPose.x - pose.x;
+            const float dy = lookaheadPose.y - pose.y;
+            const float side = dx * std::cos(heading) - dy * std::sin(heading);
+            const float distSquared = dx * dx + dy * dy;
+            const float curvature = distSquared == 0 ? 0 : 2 * side / distSquared;
+
+            const float targetVel = lemlib::slew(points[closest].speed, prevVel, lateralSettings.slew);
+            prevVel = targetVel;
+            float leftVel = targetVel * (2 + curvature * drivetrain.trackWidth) / 2;
+            float rightVel = targetVel * (2 - curvature * drivetrain.trackWidth) / 2;
+            const float ratio = std::max(std::fabs(leftVel), std::fabs(rightVel)) / 127;
+            if (ratio > 1) {
+                leftVel /= ratio;
+                rightVel /= ratio;
+            }
+
+            if (forwards) {
+                drivetrain.leftMotors->move(leftVel);
+                drivetrain.rightMotors->move(rightVel);
+            } else {
+                drivetrain.leftMotors->move(-rightVel);
+                drivetrain.rightMotors->move(-leftVel);
+            }
+            PROFILE_STOP();
+            pros::delay(10);
+        }
+        return false;
+    }
+
+    bool Chassis::ramsete(path::PathView& points, const FollowParams& params, lemlib::Timer& timer,
+                          const std::function<void()>& near) {
+        // path.jerryio ends every path with zero speed waypoints; the path ends at the first
+        int last = points.size() - 1;
+        for (int i = 1; i < points.size(); i++) {
+            if (points[i].speed == 0) {
+                last = i;
+                break;
+            }
+        }
+        const path::Waypoint& end = points[last];
+        const float endHeading = heading(points, last);
+        const float duration = end.time;
+        const float b = params.b / (INCHES_PER_METER * INCHES_PER_METER);
+        const float direction = params.forwards ? 1 : -1;
+
+        lemlib::Pose lastPose = getPose(true);
+        int segment = 0;
+        lateralPID.reset();
+        angularPID.reset();
+        lateralSmallExit.reset();
+        lateralLargeExit.reset();
+        const uint32_t start = pros::millis();
+        while (!timer.isDone() && motionRunning) {
+            PROFILE_SCOPE("ramsete cycle");
+            lemlib::Pose pose = getPose(true);
+            if (!params.forwards) pose.theta += M_PI;
+            distTraveled += pose.distance(lastPose);
+            lastPose = pose;
+            const int closest = points.closest(pose.x, pose.y, CLOSEST_WINDOW);
+            // along the final direction, so overshooting reads negative
+            const float remaining =
+                (end.x - pose.x) * std::sin(endHeading) + (end.y - pose.y) * std::cos(endHeading);
+            setTarget({Target::Kind::PATH, end.x, end.y, 0,
+                       closest >= last - 1 ? remaining : end.distance - points[closest].distance,
+                       params.forwards});
+            updateTriggers();
+            if (std::hypot(end.x - pose.x, end.y - pose.y) < lateralSettings.largeError) near();
+
+            const float t = (pros::millis() - start) / 1000.0f;
+            float leftPower;
+            float rightPower;
+            if (t >= duration) {
+                // the profile ends at rest, so on the end already is done
+                if (std::fabs(remaining) < lateralSettings.smallError) return true;
+                // the reference has stopped and RAMSETE's gains with it; close in like moveToPoint
+                const bool small = lateralSmallExit.update(remaining);
+                const bool large = lateralLargeExit.update(remaining);
+                if (small || large) return true;
+                const float lateral = std::clamp(lateralPID.update(remaining), -127.0f, 127.0f);
+                float angular = 0;
+                // steer at the end until it is too close for its bearing to mean anything
+                if (std::hypot(end.x - pose.x, end.y - pose.y) > 6) {
+                    const float bearing = std::atan2(end.x - pose.x, end.y - pose.y);
+                    angular = angularPID.update(lemlib::radToDeg(lemlib::angleError(bearing, pose.theta)));
+                }
+                leftPower = lateral + angular;
+                rightPower = lateral - angular;
+            } else {
+                // where the profile has the robot now, and a cycle ahead, when the output takes effect; the
+                // wheel accelerations come from one more cycle on, so they include the curvature changing
+                const Reference reference = sample(points, last, t, segment);
+                int next = segment;
+                const Reference feed = sample(points, last, t + 0.01f, next);
+                const Reference later = sample(points, last, t + 0.02f, next);
+
+                // error in the robot's frame: ahead, to the right, and heading
+                const float dx = reference.x - pose.x;
+                const float dy = reference.y - pose.y;
+                const float ahead = dx * std::sin(pose.theta) + dy * std::cos(pose.theta);
+                const float right = dx * std::cos(pose.theta) - dy * std::sin(pose.theta);
+                const float headingError = lemlib::angleError(reference.theta, pose.theta);
+                const float sinc = std::fabs(headingError) < 1e-4f ? 1 : std::sin(headingError) / headingError;
+                const float velocitySquared = reference.velocity * reference.velocity;
+                const float k = 2 * params.zeta * std::sqrt(reference.turn * reference.turn + b * velocitySquared);
+                const float linear = feed.velocity * std::cos(headingError) + k * ahead;
+                const float turn = feed.turn + k * headingError + b * reference.velocity * sinc * right;
+
+                // wheel velocities, each with its feedforward; velocity feedback on the forward speed
+                const float measured = direction * forwardVelocity();
+                const float feedback = profile.kD * (linear - measured);
+                const float halfTrack = drivetrain.trackWidth / 2;
+                const float acceleration = (later.velocity - feed.velocity) / 0.01f;
+                const float turnAcceleration = (later.turn - feed.turn) / 0.01f * halfTrack;
+                leftPower = feedforward(linear + turn * halfTrack, acceleration + turnAcceleration) + feedback;
+                rightPower = feedforward(linear - turn * halfTrack, acceleration - turnAcceleration) + feedback;
+            }
+
+            const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+            if (ratio > 1) {
+                leftPower /= ratio;
+                rightPower /= ratio;
+            }
+            if (params.forwards) {
+                drivetrain.leftMotors->move(leftPower);
+                drivetrain.rightMotors->move(rightPower);
+            } else {
+                drivetrain.leftMotors->move(-rightPower);
+                drivetrain.rightMotors->move(-leftPower);
+            }
+            PROFILE_STOP();
+            pros::delay(10);
+        }
+        return false;
+    }
+}
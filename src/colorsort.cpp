@@ -0,0 +1,69 @@
+#include "colorsort.hpp"
+#include <algorithm>
+
+namespace robot {
+    ColorSort::ColorSort(ColorSortSettings settings, RingSensor* sensor)
+        : settings(settings),
+          sensor(sensor) {}
+
+    void ColorSort::setRejected(RingColor color) { rejected = color; }
+
+    RingColor ColorSort::getRejected() { return rejected; }
+
+    void ColorSort::push(const Ring& ring) {
+        // more rings than fit on the intake means the readings are off; the oldest is the likeliest gone
+        if (count == CAPACITY) {
+            first = (first + 1) % CAPACITY;
+            count--;
+        }
+        rings[(first + count) % CAPACITY] = ring;
+        count++;
+    }
+
+    bool ColorSort::update(double travel) {
+        const uint32_t now = pros::millis();
+        const double advance = started ? travel - lastTravel : 0;
+        lastTravel = travel;
+        started = true;
+
+        RingDetection detection;
+        while (sensor->pop(detection)) {
+            push({detection.travel, detection.color});
+            seen++;
+        }
+        // rings run back down past the sensor
+        while (count > 0 && travel < rings[(first + count - 1) % CAPACITY].travel) count--;
+
+        if (ejecting) {
+            if (static_cast<int32_t>(now - ejectEnd) < 0) return true;
+            ejecting = false;
+        }
+        while (count > 0) {
+            const Ring ring = rings[first];
+            const double remaining = ring.travel + settings.ejectDistance - travel;
+            // stop on whichever reading lands nearest the point, this one or the next
+            if (remaining > std::max(advance, 0.0) / 2) break;
+            first = (first + 1) % CAPACITY;
+            count--;
+            if (ring.color != rejected || rejected == RingColor::NONE) continue;
+            if (-remaining > settings.lateness) continue;
+            ejecting = true;
+            ejectEnd = now + settings.ejectTime;
+            ejected++;
+            return true;
+        }
+        return false;
+    }
+
+    void ColorSort::clear() {
+        RingDetection detection;
+        while (sensor->pop(detection)) {}
+        first = 0;
+        count = 0;
+        ejecting = false;
+    }
+
+    uint32_t ColorSort::getSeen() { return seen; }
+
+    uint32_t ColorSort::getEjected() { return ejected; }
+}
@@ -7,12 +7,16 @@ namespace robot {
 
     namespace drivetrain {
         // Drive Train Motors
-        pros::MotorGroup leftMotors({-18, -20, 19}, pros::MotorGearset::blue); // -18, -20, 19
-        pros::MotorGroup rightMotors({12, -13, 14}, pros::MotorGearset::blue); // 12, -13, 14
+        robot::CachedMotorGroup leftMotors({-18, -20, 19}, pros::MotorGearset::blue); // -18, -20, 19
+        robot::CachedMotorGroup rightMotors({12, -13, 14}, pros::MotorGearset::blue); // 12, -13, 14
 
         // Sensors
         pros::Rotation verticalRotation(-1);
         pros::Imu imu(17);
+        pros::Distance frontDistance(2);
+        pros::Distance leftDistance(3);
+        pros::Distance rightDistance(4);
+        pros::Gps gps(5, 0, -0.127); // offset right and forward of the tracking centre, metres
 
         // Tracking wheel setup
         lemlib::TrackingWheel verticalTrackingWheel(
@@ -21,13 +25,17 @@ namespace robot {
             0.0
         ); 
 
+        // The drive sides as tracking wheels, for the odometry filter
+        lemlib::TrackingWheel leftDriveWheel(&leftMotors, lemlib::Omniwheel::NEW_325, -5.7, constants::drive::RPM);
+        lemlib::TrackingWheel rightDriveWheel(&rightMotors, lemlib::Omniwheel::NEW_325, 5.7, constants::drive::RPM);
+
         // Drivetrain configuration
         lemlib::Drivetrain drivetrain( 
             &leftMotors,
             &rightMotors,
-            11.4,
+            constants::drive::TRACK_WIDTH,
             lemlib::Omniwheel::NEW_325,
-            450,
+            constants::drive::RPM,
             2
         );
 
@@ -40,6 +48,32 @@ namespace robot {
             &imu
         );
 
+        // Sensor fusion odometry (constants::EKF_ODOMETRY)
+        robot::Odometry odometry(
+            {&imu, &verticalTrackingWheel, &leftDriveWheel, &rightDriveWheel},
+            robot::OdometryNoise(
+                300,   // acceleration, in/s^2
+                40,    // angular acceleration, rad/s^2
+                0.003, // IMU heading, rad
+                1,     // IMU drift, deg per minute
+                0.05,  // gyro rate, rad/s
+                0.5,   // tracking wheel, in/s
+                1,     // drift, in per 100 in
+                3,     // drive side speed, in/s
+                13.8   // slip gate: 99.9% of the chi-squared distribution with 2 degrees of freedom
+            ),
+            -1 // gyro sign: the IMU's z rate is counterclockwise positive
+        );
+
+        // GPS fusion (constants::GPS_FUSION)
+        robot::GpsSettings gpsSettings(
+            30, // latency, ms
+            2,  // maximum error, in
+            1,  // heading, deg
+            0,  // rotation of the GPS's field frame, deg
+            16.3 // gate: 99.9% of the chi-squared distribution with 3 degrees of freedom
+        );
+
         // PID Controllers
         lemlib::ControllerSettings lateralController(
             10, // kP
@@ -77,30 +111,144 @@ namespace robot {
             0.995 // Curve gain
         );
 
+        // Profiled motions. The limits and feedforward are in drive.hpp, shared with the path compiler. The
+        // feedforward is from the free speed (450 rpm on 3.25" wheels is 76.6 in/s) and the drive's time constant
+        // until the drive is characterized: run the CHARACTERIZE auto and fit its characterize.csv with
+        // tools/characterize.py
+        robot::DriveProfile driveProfile(
+            constants::drive::MAX_VELOCITY,
+            constants::drive::MAX_ACCELERATION,
+            constants::drive::MAX_JERK,
+            constants::drive::KS,
+            constants::drive::KV,
+            constants::drive::KA,
+            6,    // kP
+            0.5   // kD
+        );
+
         // Chassis instance
-        lemlib::Chassis chassis(
+        robot::Chassis chassis(
             drivetrain,
             lateralController,
             angularController,
             sensors,
+            driveProfile,
             &throttleCurve,
             &turnCurve
         );
+
+        // Wall relocalization (constants::RELOCALIZE): distance sensors as {sensor, right, forward (in), facing (deg)}
+        robot::Relocalizer relocalizer(
+            {
+                {&frontDistance, 0, 6, 0},
+                {&leftDistance, -6, 0, 270},
+                {&rightDistance, 6, 0, 90}
+            },
+            robot::RelocalizeSettings(
+                72, // walls, in from the field centre (path.jerryio's field)
+                60, // maximum range, in
+                15, // maximum incidence, deg
+                8,  // corner margin, in
+                4,  // outlier gate, in
+                30  // minimum confidence
+            ),
+            &chassis,
+            &odometry
+        );
     }
 
     namespace mechanisms {
-        pros::Motor lbMotor(10, pros::MotorGearset::red);
-        pros::Motor intakeMotor(9, pros::MotorGearset::blue);
+        robot::CachedMotor lbMotor(10, pros::MotorGearset::red);
+        robot::CachedMotor intakeMotor(9, pros::MotorGearset::blue);
    
         // Digital I/O
         pros::Rotation lbRotationSensor (15);
         pros::Optical opticalSensor(8);
 
         // Digital Out
-        pros::ADIDigitalOut hang('F');
-        pros::ADIDigitalOut clamp('H');
-        pros::ADIDigitalOut doinker('G');
-        pros::ADIDigitalOut intake('B');
+        robot::CachedDigitalOut hang('F');
+        robot::CachedDigitalOut clamp('H');
+        robot::CachedDigitalOut doinker('G');
+        robot::CachedDigitalOut intake('B');
+
+        // Ring detection: calibrate each color by holding a ring in front of the sensor with the LED on and
+        // dividing each of get_rgb()'s red, green and blue by their sum. The ring length is how far the intake
+        // turns while one ring is in view.
+        // The fractions below are not measured yet: they are a red and a blue picked by eye, so the color
+        // fractions stay off (constants::RING_FRACTIONS) and rings are told apart by the hue windows the color
+        // sort always used. To measure them, hold each color of ring in the intake at the sensor, log get_rgb()
+        // for a second with the LED at 100, and average red, green and blue over their sum, over a few rings of
+        // each color.
+        robot::RingSensor ringSensor(
+            &opticalSensor,
+            &intakeMotor,
+            true, // takes rings in running backwards
+            robot::constants::RING_FRACTIONS ? std::vector<robot::RingCalibration>{
+                {robot::RingColor::RED, 0.60, 0.23, 0.17},
+                {robot::RingColor::BLUE, 0.13, 0.32, 0.55}
+            } : std::vector<robot::RingCalibration>{},
+            {
+                {robot::RingColor::RED, 0, 25},   // hue, deg
+                {robot::RingColor::BLUE, 100, 220}
+            },
+            robot::RingSensorSettings(
+                100,  // minimum proximity
+                0.15, // maximum distance from a calibrated color
+                250   // ring length, deg
+            )
+        );
+
+        // Color sort, in intake motor degrees
+        robot::ColorSort colorSort(
+            robot::ColorSortSettings(
+                510, // eject distance, deg from the sensor to the stop
+                90,  // lateness, deg (a driver tick at full speed)
+                200  // eject time, ms
+            ),
+            &ringSensor
+        );
+
+        // Intake jams, for the blue cartridge (600 rpm, 0.35 Nm at stall)
+        robot::JamDetector intakeJam(
+            &intakeMotor,
+            robot::JamSettings(
+                100,  // minimum command, rpm
+                0.2,  // stalled under this fraction of the command
+                0.5,  // running again over this fraction
+                1800, // minimum current, mA
+                0.25, // minimum torque, Nm
+                150,  // jam time, ms
+                150,  // spin up time, ms
+                600,  // reverse speed, rpm
+                150,  // reverse time, ms
+                3     // attempts
+            )
+        );
+
+        // LB moves (constants::ARM_CONTROLLER), in rotation sensor centidegrees. The gains fit the simulator's LB
+        // (12 V is 100 rpm, 600 centidegrees/s a rpm, gravity costs 25 rpm level); characterize the real one to
+        // replace them
+        robot::ArmController lbController(
+            &lbMotor,
+            &lbRotationSensor,
+            robot::ArmSettings(
+                45000,  // maximum velocity, centidegrees/s
+                300000, // maximum acceleration, centidegrees/s^2
+                9000,   // level at, centidegrees
+                100,    // tolerance, centidegrees
+                2000,   // velocity tolerance, centidegrees/s
+                20,     // settle time, ms
+                300     // timeout after the profile, ms
+            ),
+            robot::ArmGains(
+                3000, // kG
+                0,    // kS
+                0.2,  // kV
+                0.01, // kA
+                4,    // kP
+                0.05  // kD
+            )
+        );
     } 
     namespace pid {
         // PID gains account for conversion from centidegrees to RPM
@@ -0,0 +1,213 @@
+#include "coroutine.hpp"
+#include "bench.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace robot::co {
+    Task::Task(Task&& other) noexcept
+        : handle(std::exchange(other.handle, {})) {}
+
+    Task& Task::operator=(Task&& other) noexcept {
+        if (this != &other) {
+            Task old(std::move(*this));
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    Task::~Task() {
+        if (!handle) return;
+        promise_type& promise = handle.promise();
+        if (!handle.done() && promise.root == &promise && promise.executor != nullptr) {
+            promise.executor->forget(&promise);
+        }
+        handle.destroy();
+    }
+
+    std::coroutine_handle<> Task::await_suspend(Handle awaiting) noexcept {
+        promise_type& promise = handle.promise();
+        promise.continuation = awaiting;
+        promise.root = awaiting.promise().root;
+        // start it right away instead of on the next tick
+        return handle;
+    }
+
+    void Task::await_resume() {
+        if (handle && handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+    }
+
+    Until::Until(std::function<bool()> ready, const char* name, bool check)
+        : ready(std::move(ready)),
+          name(name),
+          check(check) {}
+
+    void Until::await_suspend(Task::Handle awaiting) {
+        Task::promise_type& root = *awaiting.promise().root;
+        if (root.executor == nullptr) throw std::logic_error("co_await outside of a robot::co::Executor");
+        root.waiting = name;
+        root.executor->wait(awaiting, std::move(ready), &root);
+    }
+
+    Until until(std::function<bool()> condition, const char* name) { return Until(std::move(condition), name); }
+
+    Task sleep(uint32_t milliseconds) {
+        const uint32_t end = pros::millis() + milliseconds;
+        co_await Until([end] { return int32_t(pros::millis() - end) >= 0; }, "delay");
+    }
+
+    Until tick(const char* name) {
+        return Until([] { return true; }, name, false);
+    }
+
+    Join::Join(std::vector<Task>& tasks, Mode mode)
+        : tasks(tasks),
+          mode(mode) {}
+
+    bool Join::finished() const {
+        if (mode == Mode::ALL) return std::all_of(tasks.begin(), tasks.end(), [](const Task& task) { return task.done(); });
+        return std::any_of(tasks.begin(), tasks.end(), [](const Task& task) { return task.done(); });
+    }
+
+    bool Join::await_ready() const { return tasks.empty() || finished(); }
+
+    bool Join::await_suspend(Task::Handle awaiting) {
+        Task::promise_type& root = *awaiting.promise().root;
+        if (root.executor == nullptr) throw std::logic_error("co_await outside of a robot::co::Executor");
+        // each child is a root of its own, so it can wait on its own and be stopped on its own
+        for (Task& task : tasks) {
+            Task::promise_type& child = task.handle.promise();
+            child.executor = root.executor;
+            child.owner = &awaiting.promise();
+            task.handle.resume();
+            if (mode == Mode::ANY && task.done()) return false;
+        }
+        if (finished()) return false;
+        root.waiting = mode == Mode::ALL ? "all" : "race";
+        root.executor->wait(awaiting, [this] { return finished(); }, &root);
+        return true;
+    }
+
+    void Join::await_resume() {
+        for (Task& task : tasks) {
+            if (task.done() && task.handle.promise().exception) std::rethrow_exception(task.handle.promise().exception);
+        }
+    }
+
+    Task all(std::vector<Task> steps) {
+        co_await Join(steps, Join::Mode::ALL);
+    }
+
+    Task race(std::vector<Task> steps) {
+        // the losers are destroyed with the list
+        co_await Join(steps, Join::Mode::ANY);
+    }
+
+    Task sequence(std::vector<Task> steps) {
+        for (Task& step : steps) co_await step;
+    }
+
+    Executor::Executor(uint32_t tick)
+        : tick(std::max<uint32_t>(tick, 1)) {}
+
+    void Executor::adopt(Task& task) {
+        task.handle.promise().executor = this;
+        waiters.push_back({task.handle, {}, &task.handle.promise()});
+    }
+
+    void Executor::spawn(Task task) {
+        if (task.done()) return;
+        adopt(task);
+        spawned.push_back(std::move(task));
+    }
+
+    void Executor::post(std::function<void()> callback) {
+        postMutex.take();
+        posted.push_back(std::move(callback));
+        postMutex.give();
+    }
+
+    void Executor::wait(std::coroutine_handle<> handle, std::function<bool()> ready, Task::promise_type* root) {
+        waiters.push_back({handle, std::move(ready), root});
+    }
+
+    void Executor::forget(Task::promise_type* root) {
+        const auto startedBy = [root](const Waiter& waiter) {
+            for (Task::promise_type* promise = waiter.root; promise != nullptr;
+                 promise = promise->owner == nullptr ? nullptr : promise->owner->root) {
+                if (promise == root) return true;
+            }
+            return false;
+        };
+        std::erase_if(waiters, startedBy);
+        for (Waiter& waiter : due) {
+            if (waiter.handle && startedBy(waiter)) waiter.handle = {};
+        }
+    }
+
+    void Executor::step() {
+        std::vector<std::function<void()>> callbacks;
+        postMutex.take();
+        callbacks.swap(posted);
+        postMutex.give();
+        for (const std::function<void()>& callback : callbacks) callback();
+
+        // coroutines resumed now suspend onto the back of the list again, keeping their order
+        due.swap(waiters);
+        for (size_t i = 0; i < due.size(); i++) {
+            // a coroutine resumed earlier in the tick may have stopped this one
+            if (!due[i].handle) continue;
+            if (due[i].ready && !due[i].ready()) {
+                waiters.push_back(std::move(due[i]));
+            } else {
+                const std::coroutine_handle<> handle = due[i].handle;
+                handle.resume();
+            }
+        }
+        due.clear();
+    }
+
+    void Executor::run(Task main) {
+        if (main.done()) return;
+        adopt(main);
+        uint32_t now = pros::millis();
+        while (true) {
+            step();
+            if (main.done()) break;
+            BENCH_CALL(main.handle.promise().waiting);
+            pros::Task::delay_until(&now, tick);
+        }
+        lastTick = now;
+        main.await_resume();
+    }
+
+    void Executor::start(const char* name, std::function<bool()> condition) {
+        pros::Task task([this, condition]() {
+            uint32_t now = lastTick;
+            while (true) {
+                pros::Task::delay_until(&now, tick);
+                if (!condition()) break;
+                step();
+            }
+            clear();
+        }, name);
+    }
+
+    void Executor::clear() {
+        // the frames hold the coroutines they are waiting on, so destroying the spawned ones is enough
+        waiters.clear();
+        spawned.clear();
+        postMutex.take();
+        posted.clear();
+        postMutex.give();
+    }
+
+    void Executor::reset() {
+        waiters.clear();
+        for (Task& task : spawned) task.handle = {};
+        spawned.clear();
+        postMutex.take();
+        posted.clear();
+        postMutex.give();
+    }
+}
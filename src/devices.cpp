@@ -0,0 +1,123 @@
+#include "devices.hpp"
+
+namespace robot {
+    CommandCache::Counters CommandCache::totals;
+
+    // Motor
+
+    std::int32_t CachedMotor::move(std::int32_t voltage) const {
+        return output.write(CommandCache::Kind::MOVE, voltage, [&] { return pros::Motor::move(voltage); });
+    }
+
+    std::int32_t CachedMotor::move_velocity(std::int32_t velocity) const {
+        return output.write(CommandCache::Kind::VELOCITY, velocity,
+                            [&] { return pros::Motor::move_velocity(velocity); });
+    }
+
+    std::int32_t CachedMotor::move_voltage(std::int32_t voltage) const {
+        return output.write(CommandCache::Kind::VOLTAGE, voltage,
+                            [&] { return pros::Motor::move_voltage(voltage); });
+    }
+
+    std::int32_t CachedMotor::brake() const {
+        return output.write(CommandCache::Kind::BRAKE, 0, [&] { return pros::Motor::brake(); });
+    }
+
+    std::int32_t CachedMotor::set_brake_mode(pros::motor_brake_mode_e_t mode, std::uint8_t index) const {
+        return brakeMode.write(CommandCache::Kind::VALUE, mode,
+                               [&] { return pros::Motor::set_brake_mode(mode, index); });
+    }
+
+    std::int32_t CachedMotor::set_brake_mode(pros::MotorBrake mode, std::uint8_t index) const {
+        return set_brake_mode(static_cast<pros::motor_brake_mode_e_t>(mode), index);
+    }
+
+    // a single motor, so the same setting as set_brake_mode
+    std::int32_t CachedMotor::set_brake_mode_all(pros::motor_brake_mode_e_t mode) const {
+        return brakeMode.write(CommandCache::Kind::VALUE, mode,
+                               [&] { return pros::Motor::set_brake_mode_all(mode); });
+    }
+
+    std::int32_t CachedMotor::set_brake_mode_all(pros::MotorBrake mode) const {
+        return set_brake_mode_all(static_cast<pros::motor_brake_mode_e_t>(mode));
+    }
+
+    void CachedMotor::setRefresh(uint32_t period) const {
+        output.setRefresh(period);
+        brakeMode.setRefresh(period);
+    }
+
+    void CachedMotor::forget() const {
+        output.forget();
+        brakeMode.forget();
+    }
+
+    // Motor group
+
+    std::int32_t CachedMotorGroup::move(std::int32_t voltage) const {
+        return commanded(
+            output.write(CommandCache::Kind::MOVE, voltage, [&] { return pros::MotorGroup::move(voltage); }));
+    }
+
+    std::int32_t CachedMotorGroup::move_velocity(std::int32_t velocity) const {
+        return commanded(output.write(CommandCache::Kind::VELOCITY, velocity,
+                                      [&] { return pros::MotorGroup::move_velocity(velocity); }));
+    }
+
+    std::int32_t CachedMotorGroup::move_voltage(std::int32_t voltage) const {
+        return commanded(output.write(CommandCache::Kind::VOLTAGE, voltage,
+                                      [&] { return pros::MotorGroup::move_voltage(voltage); }));
+    }
+
+    std::int32_t CachedMotorGroup::brake() const {
+        return commanded(output.write(CommandCache::Kind::BRAKE, 0, [&] { return pros::MotorGroup::brake(); }));
+    }
+
+    std::int32_t CachedMotorGroup::set_brake_mode(pros::motor_brake_mode_e_t mode, std::uint8_t index) const {
+        // only one motor changes, so the group no longer has a single mode
+        brakeMode.forget();
+        return pros::MotorGroup::set_brake_mode(mode, index);
+    }
+
+    std::int32_t CachedMotorGroup::set_brake_mode(pros::MotorBrake mode, std::uint8_t index) const {
+        return set_brake_mode(static_cast<pros::motor_brake_mode_e_t>(mode), index);
+    }
+
+    std::int32_t CachedMotorGroup::set_brake_mode_all(pros::motor_brake_mode_e_t mode) const {
+        return brakeMode.write(CommandCache::Kind::VALUE, mode,
+                               [&] { return pros::MotorGroup::set_brake_mode_all(mode); });
+    }
+
+    std::int32_t CachedMotorGroup::set_brake_mode_all(pros::MotorBrake mode) const {
+        return set_brake_mode_all(static_cast<pros::motor_brake_mode_e_t>(mode));
+    }
+
+    void CachedMotorGroup::setRefresh(uint32_t period) const {
+        output.setRefresh(period);
+        brakeMode.setRefresh(period);
+    }
+
+    void CachedMotorGroup::forget() const {
+        output.forget();
+        brakeMode.forget();
+    }
+
+    void CachedMotorGroup::onCommand(std::function<void()> hook) { this->hook = std::move(hook); }
+
+    std::int32_t CachedMotorGroup::commanded(std::int32_t result) const {
+        if (hook) hook();
+        return result;
+    }
+
+    // Digital out
+
+    std::int32_t CachedDigitalOut::set_value(std::int32_t value) const {
+        // any non-zero value drives the port high
+        return state.write(CommandCache::Kind::VALUE, value != 0,
+                           [&] { return pros::ADIDigitalOut::set_value(value); });
+    }
+
+    void CachedDigitalOut::setRefresh(uint32_t period) const { state.setRefresh(period); }
+
+    void CachedDigitalOut::forget() const { state.forget(); }
+}
@@ -0,0 +1,130 @@
+#include "flightlog.hpp"
+#include "config.hpp"
+#include "profile.hpp"
+#include "scheduler.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // average velocity and total current of one side of the drive
+    void side(const pros::MotorGroup& motors, float& velocity, float& current) {
+        velocity = 0;
+        current = 0;
+        const int count = motors.size();
+        for (int i = 0; i < count; i++) {
+            velocity += motors.get_actual_velocity(i);
+            current += motors.get_current_draw(i);
+        }
+        if (count > 0) velocity /= count;
+    }
+}
+
+namespace robot {
+    FlightLog flightLog;
+
+    FlightLog::FlightLog()
+        : writer([this](const telemetry::Record& record) { store(record); }) {
+        writer.add(samples);
+    }
+
+    bool FlightLog::start() {
+        if (file != nullptr) return true;
+        char name[256];
+        FILE* opened = nullptr;
+        for (int i = 0; i < 1000 && opened == nullptr; i++) {
+            std::snprintf(name, sizeof(name), "%s/flight%03d.bin", directory, i);
+            if (FILE* existing = std::fopen(name, "rb")) {
+                std::fclose(existing);
+                continue;
+            }
+            // fails when there is no card
+            opened = std::fopen(name, "wb");
+            if (opened == nullptr) return false;
+        }
+        if (opened == nullptr) return false;
+
+        const Header header = {{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, VERSION, sizeof(Sample), FIELDS, PERIOD};
+        std::fwrite(&header, sizeof(header), 1, opened);
+        for (const char* field : FIELD_NAMES) std::fwrite(field, 1, std::strlen(field) + 1, opened);
+        std::fflush(opened);
+        file = opened;
+        logging = true;
+        if (tasksStarted) return true;
+        tasksStarted = true;
+
+        pros::Task(
+            [this]() {
+                while (true) {
+                    writer.drain();
+                    if (closeRequested) {
+                        if (used > 0) writeBlock();
+                        std::fclose(file);
+                        file = nullptr;
+                        closeRequested = false;
+                    } else if (used > 0 && pros::millis() - writtenAt >= FLUSH_PERIOD) {
+                        writeBlock();
+                    }
+                    pros::delay(PERIOD);
+                }
+            },
+            TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT, "Flight log writer");
+        static Scheduler sampler(PERIOD);
+        sampler.add("flightlog", PERIOD, 0, [this]() { sample(); });
+        sampler.start("Flight log");
+        return true;
+    }
+
+    void FlightLog::stop() {
+        if (file == nullptr) return;
+        logging = false;
+        closeRequested = true;
+        while (closeRequested) pros::delay(PERIOD);
+    }
+
+    void FlightLog::sample() {
+        if (!logging) return;
+        PROFILE_SCOPE("flightlog");
+        Sample sample;
+        const lemlib::Pose pose = drivetrain::chassis.getPose();
+        sample.x = pose.x;
+        sample.y = pose.y;
+        sample.theta = pose.theta;
+        side(drivetrain::leftMotors, sample.leftVelocity, sample.leftCurrent);
+        side(drivetrain::rightMotors, sample.rightVelocity, sample.rightCurrent);
+        sample.lateralError = drivetrain::chassis.lateralError();
+        sample.angularError = drivetrain::chassis.angularError();
+        sample.intakeVelocity = mechanisms::intakeMotor.get_actual_velocity();
+        sample.hue = mechanisms::opticalSensor.get_hue();
+        sample.lbPosition = mechanisms::lbRotationSensor.get_position();
+
+        // everything but the time, which the record carries in ms (us would wrap after 71 minutes)
+        telemetry::Record record = {pros::millis(), telemetry::FLIGHT, FIELDS - 1, {}};
+        std::memcpy(record.fields, &sample.x, (FIELDS - 1) * sizeof(float));
+        if (samples.push(record)) {
+            totals.samples++;
+        } else {
+            totals.dropped++;
+        }
+    }
+
+    void FlightLog::store(const telemetry::Record& record) {
+        // sampled just before stop()
+        if (file == nullptr) return;
+        if (used + sizeof(Sample) > BLOCK_SIZE) writeBlock();
+        Sample sample;
+        sample.time = record.time;
+        std::memcpy(&sample.x, record.fields, (FIELDS - 1) * sizeof(float));
+        std::memcpy(block + used, &sample, sizeof(sample));
+        used += sizeof(sample);
+    }
+
+    void FlightLog::writeBlock() {
+        const uint64_t start = pros::micros();
+        std::fwrite(block, 1, used, file);
+        std::fflush(file);
+        totals.maxWrite = std::max<uint32_t>(totals.maxWrite, pros::micros() - start);
+        totals.blocks++;
+        used = 0;
+        writtenAt = pros::millis();
+    }
+}
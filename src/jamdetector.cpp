@@ -0,0 +1,106 @@
+#include "jamdetector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    void printJam(const robot::telemetry::Record& record, FILE* file) {
+        const float* field = record.fields;
+        std::fprintf(file, "jam on port %d: %lu ms, %d reverses, %s\n", (int)field[0], (unsigned long)field[1],
+                     (int)field[2], robot::telemetry::lookup(field[3]));
+    }
+}
+
+namespace robot {
+    JamDetector::JamDetector(pros::Motor* motor, JamSettings settings)
+        : motor(motor),
+          settings(settings) {
+        telemetry::setFormatter(telemetry::JAM, printJam);
+        telemetry::log().add(reports);
+    }
+
+    void JamDetector::end(uint32_t now, const char* outcome) {
+        const uint32_t duration = now - jamStart;
+        totals.jammedTime += duration;
+        totals.longest = std::max(totals.longest, duration);
+        jammed = false;
+        // printed by the telemetry task, not from the control loop
+        reports.push(telemetry::JAM, {float(motor->get_port()), float(duration), float(attempts),
+                                      float(telemetry::intern(outcome))});
+    }
+
+    double JamDetector::update(double command) {
+        const uint32_t now = pros::millis();
+        const bool wasRunning = std::fabs(lastCommand) >= settings.minCommand;
+        const bool turned = (command > 0) != (lastCommand > 0);
+        lastCommand = command;
+
+        if (std::fabs(command) < settings.minCommand) {
+            if (jammed) end(now, "stopped");
+            reversing = false;
+            gaveUp = false;
+            stallStart = 0;
+            return command;
+        }
+        if (!wasRunning || turned) {
+            if (jammed) end(now, "stopped");
+            reversing = false;
+            gaveUp = false;
+            stallStart = 0;
+            spinUpEnd = now + settings.spinUpTime;
+        }
+
+        if (reversing) {
+            if (static_cast<int32_t>(now - reverseEnd) < 0) return reverseCommand;
+            reversing = false;
+            spinUpEnd = now + settings.spinUpTime;
+        }
+
+        const double speed = std::fabs(command);
+        const double direction = command > 0 ? 1 : -1;
+        const double along = direction * motor->get_actual_velocity();
+        if (along >= settings.recoverFraction * speed) {
+            stallStart = 0;
+            // up to speed again after a reverse is not enough, it has to get past where it stalled
+            if (jammed && direction * (motor->get_position() - jamPosition) > 0) {
+                totals.cleared++;
+                end(now, "cleared");
+            }
+            return command;
+        }
+        if (gaveUp || static_cast<int32_t>(now - spinUpEnd) < 0) return command;
+
+        // a stall starts under stallFraction and lasts until the motor is back over recoverFraction
+        if (stallStart == 0) {
+            const bool loaded = motor->get_current_draw() >= settings.minCurrent ||
+                                motor->get_torque() >= settings.minTorque;
+            if (along < settings.stallFraction * speed && loaded) stallStart = std::max(now, 1u);
+        }
+        if (stallStart == 0 || now - stallStart < settings.jamTime) return command;
+
+        if (!jammed) {
+            jammed = true;
+            jamStart = stallStart;
+            jamPosition = motor->get_position();
+            attempts = 0;
+            totals.jams++;
+        }
+        stallStart = 0;
+        if (attempts == settings.maxAttempts) {
+            gaveUp = true;
+            end(now, "gave up");
+            return command;
+        }
+        attempts++;
+        totals.reverses++;
+        reversing = true;
+        // each attempt backs off further
+        reverseEnd = now + settings.reverseTime * attempts;
+        reverseCommand = -direction * settings.reverseSpeed;
+        return reverseCommand;
+    }
+
+    bool JamDetector::isJammed() { return jammed; }
+
+    bool JamDetector::isReversing() { return reversing; }
+}
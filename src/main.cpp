@@ -4,6 +4,11 @@
 #include "timer.hpp"
 #include "config.hpp"
 #include "auto.h"
+#include "scheduler.hpp"
+#include "sensorframe.hpp"
+#include "flightlog.hpp"
+#include "telemetry.hpp"
+#include "profile.hpp"
 #include <cstdint>
 #include <limits>
 #include <utility>
@@ -38,19 +43,6 @@ namespace controls {
             18000.0   // CLEAR
         };
 
-        struct intakeState {
-            inline static bool targetColor = (current_auto == AutonomousMode::BLUE_RING ||
-            current_auto == AutonomousMode::BLUE_STAKE); // false = red team (eject blue), true = blue team (eject red)
-            inline static std::pair<double, Timer> pendingEjectTimers[2] = {{0, Timer(200)}, {0, Timer(200)}};
-            inline static double lastSeenUnits = 0.0;
-            inline static bool isEjecting = false;
-        };
-
-        static constexpr bool ENABLE_COLOR_SORT = true;
-        static constexpr double EJECT_COOLDOWN_UNIT = 660.0;
-        static constexpr double EJECT_EJECTING_INTERVAL_UNIT = 400.0;
-        static constexpr double EJECT_DELAY_UNIT = 510.0;
-
         static constexpr int LB_POSITION_LOSS_BOUNDARY = 6000;
         static constexpr int LB_FINETUNE_BOUNDARY = 5200;
         static constexpr double MIN_VELOCITY = 50.0;  
@@ -87,14 +79,15 @@ namespace controls {
             return targetVelocity;
         }
     public:     
-        static void update_LB(){ 
+        static void update_LB(const robot::SensorFrame& frame) { 
+            PROFILE_SCOPE("lb");
             // Static Variables
             static LBToggleState lbState = LBToggleState::IDLE;
             static bool isAutoMoving = false;
             static bool isOutOfBounds = false;
 
             // Position Variables
-            double currentPosition = robot::mechanisms::lbRotationSensor.get_position();
+            double currentPosition = frame.lbPosition();
 
             // Manual Speed Variables
             int manualSpeed = (currentPosition < LB_FINETUNE_BOUNDARY) ? 20 : 100;
@@ -109,26 +102,27 @@ namespace controls {
             }
 
             // Manual Movement
-            if (robot::masterController.get_digital(pros::E_CONTROLLER_DIGITAL_L2)) {
+            if (frame.held(pros::E_CONTROLLER_DIGITAL_L2)) {
+                robot::mechanisms::lbController.stop();
                 robot::mechanisms::lbMotor.move_velocity(-manualSpeed);
                 isOutOfBounds = true;
                 isAutoMoving = false;
 
-            } else if (robot::masterController.get_digital(pros::E_CONTROLLER_DIGITAL_R2)) {
+            } else if (frame.held(pros::E_CONTROLLER_DIGITAL_R2)) {
+                robot::mechanisms::lbController.stop();
                 robot::mechanisms::lbMotor.move_velocity(manualSpeed);
                 isOutOfBounds = true;
                 isAutoMoving = false;
 
             } else if (!isAutoMoving) {
-                double currentVelocity = robot::mechanisms::lbMotor.get_actual_velocity();
+                double currentVelocity = frame.lbVelocity();
                 currentVelocity = slewMove(0, currentVelocity);
                 robot::mechanisms::lbMotor.move_velocity(currentVelocity);
             }
 
             // Toggle Auto Movement
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_RIGHT)) {
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_RIGHT)) {
                 isAutoMoving = true;
-                robot::pid::lbPID.reset();
 
                 // After user interrupts
                 if (isOutOfBounds) {
@@ -153,13 +147,15 @@ namespace controls {
                         break;
                     }
                 }
+                if (robot::constants::ARM_CONTROLLER) {
+                    robot::mechanisms::lbController.moveTo(LB_POSITIONS[static_cast<int>(lbState)]);
+                } else {
+                    robot::pid::lbPID.reset();
+                }
             }
 
             // Auto Movement 
             if (isAutoMoving) {
-                double targetPosition = LB_POSITIONS[static_cast<int>(lbState)];
-                double error = targetPosition - currentPosition;
-
                 if (rollBackTimer.isTimerRunning()) {
                     robot::mechanisms::intakeMotor.move_velocity(600);
                 } else {
@@ -167,16 +163,20 @@ namespace controls {
                     robot::mechanisms::intakeMotor.move_velocity(0);
                 }
 
-                // Get PID output
-                double pidOutput = robot::pid::lbPID.update(error);
-                double velocityCommand = std::clamp(pidOutput, -100.0, 100.0);
-                
-                // Apply the output
-                robot::mechanisms::lbMotor.move_velocity(velocityCommand);
-                
-                if (std::abs(error) < 100) {  
+                bool arrived;
+                if (robot::constants::ARM_CONTROLLER) {
+                    robot::mechanisms::lbController.update();
+                    arrived = !robot::mechanisms::lbController.isMoving();
+                } else {
+                    double error = LB_POSITIONS[static_cast<int>(lbState)] - currentPosition;
+                    double pidOutput = robot::pid::lbPID.update(error);
+                    double velocityCommand = std::clamp(pidOutput, -100.0, 100.0);
+                    robot::mechanisms::lbMotor.move_velocity(velocityCommand);
+                    arrived = std::abs(error) < 100;
+                    if (arrived) robot::mechanisms::lbMotor.move_velocity(0);
+                }
+                if (arrived) {
                     isAutoMoving = false;
-                    robot::mechanisms::lbMotor.move_velocity(0);
                     if (lbState == LBToggleState::IDLE) {
                         robot::mechanisms::lbRotationSensor.reset_position();
                     }
@@ -184,20 +184,21 @@ namespace controls {
             }
         }
 
-        static void drive(){
+        static void drive(const robot::SensorFrame& frame) {
+            PROFILE_SCOPE("drive");
             static bool reverseDrive = false;
             static bool brakeMode = false;
 
 
-            int x = robot::masterController.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
-            int y = robot::masterController.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_Y)) {
+            int x = frame.analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+            int y = frame.analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_Y)) {
                 reverseDrive = !reverseDrive;
             }
             if (reverseDrive) {
                 x = -x;
             }
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_X)) {
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_X)) {
                 brakeMode = !brakeMode;
                 if (brakeMode) {
                     pros::delay(500);
@@ -210,101 +211,50 @@ namespace controls {
             robot::drivetrain::chassis.arcade(x, y);
         }
         
-        static void update_hang() {
+        static void update_hang(const robot::SensorFrame& frame) {
             
             static bool hangState = false;
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_LEFT)) {
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_LEFT)) {
                 hangState = !hangState;
                 robot::mechanisms::hang.set_value(hangState);
             }
         }
 
-        static void update_intake() {
+        static void update_intake(const robot::SensorFrame& frame) {
+            PROFILE_SCOPE("intake");
             static bool intakeToggle = false;
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_UP)) {
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_UP)) {
                 intakeToggle = !intakeToggle;
             }
+            // the color sort follows the rings whether or not the intake is running
+            const bool ejecting = robot::mechanisms::colorSort.update(-frame.intakePosition());
 
             const int intake_speed = robot::constants::INTAKE_SPEED;
-            if (robot::masterController.get_digital(pros::E_CONTROLLER_DIGITAL_R1)) { 
-                if (ENABLE_COLOR_SORT) {
-
-                    // pros::lcd::print(1, "First: (%f, %f)", intakeState::pendingEjectTimers[0].first, intakeState::pendingEjectTimers[0].second.getTimeRemaining());
-                    // pros::lcd::print(2, "Second: (%f, %f)", intakeState::pendingEjectTimers[1].first, intakeState::pendingEjectTimers[1].second.getTimeRemaining());
-                    // pros::lcd::print(3, "Ejecting: %d", intakeState::isEjecting);
-                    double current_revolution = std::abs(robot::mechanisms::intakeMotor.get_position());
-                    if (intakeState::targetColor) { // Blue team rejecting red
-                        if (robot::mechanisms::opticalSensor.get_hue() >= 0 && 
-                            robot::mechanisms::opticalSensor.get_hue() <= 25 &&
-                            current_revolution - intakeState::lastSeenUnits > EJECT_COOLDOWN_UNIT) {
-                            for (int i = 0; i < 2; i++) {
-                                if (intakeState::pendingEjectTimers[i].first == 0.0) {
-                                    intakeState::pendingEjectTimers[i].first = current_revolution + EJECT_DELAY_UNIT;
-                                    intakeState::lastSeenUnits = current_revolution;
-                                    break;
-                                }
-                            }
-                        }
-                        
-                    } else if (!intakeState::targetColor) {
-                        if (robot::mechanisms::opticalSensor.get_hue() >= 100 && 
-                            robot::mechanisms::opticalSensor.get_hue() <= 220 &&
-                            current_revolution - intakeState::lastSeenUnits > EJECT_COOLDOWN_UNIT) {
-                            for (int i = 0; i < 2; i++) {
-                                if (intakeState::pendingEjectTimers[i].first == 0.0) {
-                                    intakeState::pendingEjectTimers[i].first = current_revolution + EJECT_DELAY_UNIT;
-                                    intakeState::lastSeenUnits = current_revolution;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-
-                    for (int i = 0; i < 2; i++) {
-                        if (intakeState::pendingEjectTimers[i].first != 0.0) {
-
-                            if (intakeState::pendingEjectTimers[i].first <= current_revolution && 
-                                intakeState::pendingEjectTimers[i].second.isTimerRunning()) {
-
-                                intakeState::pendingEjectTimers[i].second.start();
-                                intakeState::isEjecting = true;
-                                break;
-                            } else if (intakeState::pendingEjectTimers[i].second.isDone()) {
-                                intakeState::pendingEjectTimers[i].first = 0.0;
-                                intakeState::pendingEjectTimers[i].second.reset();
-                                intakeState::isEjecting = false;
-                            }
-                        }
-                    }
-
-                    if (intakeState::isEjecting) {
-                        robot::mechanisms::intakeMotor.move_velocity(0);
-                    } else {
-                        robot::mechanisms::intakeMotor.move_velocity(-intake_speed);
-                    }
-                } else {
-                    robot::mechanisms::intakeMotor.move_velocity(-intake_speed);
-                }
-            } else if (robot::masterController.get_digital(pros::E_CONTROLLER_DIGITAL_L1)) {
-                robot::mechanisms::intakeMotor.move_velocity(intake_speed);
+            double command = 0;
+            if (frame.held(pros::E_CONTROLLER_DIGITAL_R1)) { 
+                command = ejecting ? 0 : -intake_speed;
+            } else if (frame.held(pros::E_CONTROLLER_DIGITAL_L1)) {
+                command = intake_speed;
             } else if (intakeToggle) {
-                robot::mechanisms::intakeMotor.move_velocity(-intake_speed);
-            } else {    
-                robot::mechanisms::intakeMotor.move_velocity(0);
+                command = ejecting ? 0 : -intake_speed;
             }
+            if (robot::constants::JAM_RECOVERY) {
+                command = robot::mechanisms::intakeJam.update(command);
+            }
+            robot::mechanisms::intakeMotor.move_velocity(command);
         }
 
-        static void update_clamp() {
+        static void update_clamp(const robot::SensorFrame& frame) {
             static bool clampState = false;
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_B)) {
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_B)) {
                 clampState = !clampState;
                 robot::mechanisms::clamp.set_value(clampState);
             }
         }
 
-        static void update_doinker() {
+        static void update_doinker(const robot::SensorFrame& frame) {
             static bool doinkerState = false;
-            if (robot::masterController.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_DOWN)) {
+            if (frame.pressed(pros::E_CONTROLLER_DIGITAL_DOWN)) {
                 doinkerState = !doinkerState;
                 robot::mechanisms::doinker.set_value(doinkerState);
             }
@@ -323,26 +273,78 @@ namespace controls {
 void initialize() {
     pros::lcd::initialize(); // initialize brain screen
     
-    robot::drivetrain::chassis.calibrate(); // calibrate sensors
+    if (robot::constants::EKF_ODOMETRY) {
+        robot::drivetrain::chassis.setOdometry(&robot::drivetrain::odometry);
+        robot::drivetrain::odometry.start(); // calibrates the IMU, in place of LemLib's odometry
+        if (robot::constants::RELOCALIZE) {
+            robot::drivetrain::relocalizer.start(); // trims the pose from the walls the distance sensors see
+        }
+        if (robot::constants::GPS_FUSION) {
+            robot::drivetrain::odometry.setGps(&robot::drivetrain::gps, robot::drivetrain::gpsSettings);
+        }
+    } else {
+        robot::drivetrain::chassis.calibrate(); // calibrate sensors
+    }
     robot::mechanisms::lbMotor.set_brake_mode(pros::E_MOTOR_BRAKE_COAST);
+    // an eject stop has to stop the hooks dead for the ring to fly off
+    robot::mechanisms::intakeMotor.set_brake_mode(pros::E_MOTOR_BRAKE_BRAKE);
     robot::drivetrain::chassis.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
     robot::mechanisms::lbRotationSensor.reset_position();
 
     robot::mechanisms::opticalSensor.set_led_pwm(100);
+    robot::mechanisms::ringSensor.start(); // samples the optical sensor for the color sort
+    robot::telemetry::log().start(); // prints the scheduler and jam reports
     // print position to brain screen
-    pros::Task screen_task([&]() { 
-        while (true) {
-
-            // // Debugging Printing Area
-            // pros::lcd::print(0, "Chassis Position: x: %f", robot::drivetrain::chassis.getPose().x);
-            // pros::lcd::print(1, "Chassis Position: y: %f", robot::drivetrain::chassis.getPose().y);
-            // pros::lcd::print(2, "Chassis Position: heading : %f", robot::drivetrain::chassis.getPose().theta);
-            // pros::lcd::print(3, "Intake Motor: %f", robot::mechanisms::intakeMotor.get_actual_velocity());
+    static robot::Scheduler screenScheduler;
+    screenScheduler.add("screen", robot::constants::LOOP_DELAY, 0, []() {
+#ifdef PROFILE
+        // screen buttons: left switches to the profile page and back, center prints the profile to the
+        // terminal, right clears it
+        static bool profilePage = false;
+        static uint8_t lastButtons = 0;
+        const uint8_t buttons = pros::lcd::read_buttons();
+        const uint8_t pressed = buttons & ~lastButtons;
+        lastButtons = buttons;
+        if (pressed & LCD_BTN_LEFT) {
+            profilePage = !profilePage;
+            pros::lcd::clear();
+        }
+        if (pressed & LCD_BTN_CENTER) robot::profile::print();
+        if (pressed & LCD_BTN_RIGHT) robot::profile::reset();
+        if (profilePage) {
+            pros::lcd::print(0, "%-12s %6s %6s %6s us", "region", "mean", "p99", "max");
+            for (int i = 0; i < robot::profile::regionCount() && i < 7; i++) {
+                const robot::profile::Region& region = robot::profile::regionAt(i);
+                pros::lcd::print(i + 1, "%-12s %6lu %6lu %6lu", region.name, (unsigned long)region.mean(),
+                                 (unsigned long)region.p99(), (unsigned long)region.max);
+            }
+            return;
+        }
+#endif
+        // // Debugging Printing Area
+        // pros::lcd::print(0, "Chassis Position: x: %f", robot::drivetrain::chassis.getPose().x);
+        // pros::lcd::print(1, "Chassis Position: y: %f", robot::drivetrain::chassis.getPose().y);
+        // pros::lcd::print(2, "Chassis Position: heading : %f", robot::drivetrain::chassis.getPose().theta);
+        // pros::lcd::print(3, "Intake Motor: %f", robot::mechanisms::intakeMotor.get_actual_velocity());
+
+        if (robot::flightLog.running()) {
+            const robot::FlightLog::Counters& log = robot::flightLog.counters();
+            pros::lcd::print(5, "Log samples: %lu, dropped: %lu", (unsigned long)log.samples,
+                             (unsigned long)log.dropped);
+        }
 
+        // device writes the command cache dropped
+        const robot::CommandCache::Counters& writes = robot::CommandCache::counters();
+        pros::lcd::print(6, "Writes sent: %lu, dropped: %lu", (unsigned long)writes.forwarded,
+                         (unsigned long)writes.suppressed);
 
-            pros::delay(robot::constants::LOOP_DELAY);
-        }   
+        // device reads the opcontrol sensor frame saved the handlers
+        const robot::SensorFrame::Counters& counters = robot::SensorFrame::counters();
+        if (counters.frames > 0) {
+            pros::lcd::print(7, "Frame reads: %lu, saved: %ld", (unsigned long)counters.reads, (long)counters.saved());
+        }
     });
+    screenScheduler.start("Screen");
 }
 
 
@@ -351,7 +353,7 @@ void initialize() {
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}  
+void disabled() { robot::flightLog.stop(); }
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -378,20 +380,23 @@ void competition_initialize() {}
  * task, not resume it from where it left off.
  */
 void opcontrol() {
+    robot::flightLog.start(); // a file each time the robot is enabled, only with an SD card in
+    restore_gps(); // autonomous may have been cut off mid routine
     robot::mechanisms::doinker.set_value(false);
+    robot::mechanisms::colorSort.setRejected(rejected_color());
     Timer allianceTimer = Timer(1000);
     allianceTimer.start();
 
 
-    while (true) {
-
-        controls::Mechanisms::drive();
-        controls::Mechanisms::update_hang();
-        controls::Mechanisms::update_intake();      
-        controls::Mechanisms::update_clamp();
-        controls::Mechanisms::update_LB(); // Needs to be after update_intake
-        controls::Mechanisms::update_doinker();
-
-        pros::delay(robot::constants::LOOP_DELAY);
-    }
-}
\ No newline at end of file
+    // Jobs due on the same tick run highest priority first; the frame is sampled before the rest
+    robot::SensorFrame frame;
+    robot::Scheduler scheduler(robot::constants::LOOP_DELAY);
+    scheduler.add("frame", robot::constants::LOOP_DELAY, 7, [&]() { frame.sample(); });
+    scheduler.add("drive", robot::constants::LOOP_DELAY, 6, [&]() { controls::Mechanisms::drive(frame); });
+    scheduler.add("hang", robot::constants::LOOP_DELAY, 5, [&]() { controls::Mechanisms::update_hang(frame); });
+    scheduler.add("intake", robot::constants::LOOP_DELAY, 4, [&]() { controls::Mechanisms::update_intake(frame); });
+    scheduler.add("clamp", robot::constants::LOOP_DELAY, 3, [&]() { controls::Mechanisms::update_clamp(frame); });
+    scheduler.add("lb", robot::constants::LOOP_DELAY, 2, [&]() { controls::Mechanisms::update_LB(frame); }); // Needs to be after update_intake
+    scheduler.add("doinker", robot::constants::LOOP_DELAY, 1, [&]() { controls::Mechanisms::update_doinker(frame); });
+    scheduler.run();
+}
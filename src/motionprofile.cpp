@@ -0,0 +1,163 @@
+#include "motionprofile.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace robot {
+    SCurve::SCurve(float distance, float startVelocity, float endVelocity, ProfileLimits limits)
+        : length(std::max(distance, 0.0f)),
+          start(std::clamp(startVelocity, 0.0f, limits.velocity)),
+          end(std::clamp(endVelocity, 0.0f, limits.velocity)),
+          jerk(limits.jerk) {
+        if (length == 0) {
+            end = start;
+            peak = start;
+            return;
+        }
+        if (plan(limits)) return;
+        // too short to reach the end velocity; keeping the start velocity is always possible
+        float reachable = start;
+        float unreachable = end;
+        for (int i = 0; i < 24; i++) {
+            end = (reachable + unreachable) / 2;
+            if (plan(limits)) reachable = end;
+            else unreachable = end;
+        }
+        end = reachable;
+        plan(limits);
+    }
+
+    bool SCurve::plan(ProfileLimits limits) {
+        float acceleration = limits.acceleration;
+        const float maxVelocity = limits.velocity;
+        const float sum = start + end;
+
+        // can the velocity change from start to end within the distance at all?
+        const float change = std::fabs(end - start);
+        const float minJerkTime = std::min(std::sqrt(change / jerk), acceleration / jerk);
+        if (minJerkTime < acceleration / jerk) {
+            if (length < minJerkTime * sum) return false;
+        } else if (length < 0.5f * sum * (minJerkTime + change / acceleration)) {
+            return false;
+        }
+
+        // cruising at the velocity limit
+        if ((maxVelocity - start) * jerk < acceleration * acceleration) {
+            accelJerkTime = std::sqrt((maxVelocity - start) / jerk);
+            accelTime = 2 * accelJerkTime;
+        } else {
+            accelJerkTime = acceleration / jerk;
+            accelTime = accelJerkTime + (maxVelocity - start) / acceleration;
+        }
+        if ((maxVelocity - end) * jerk < acceleration * acceleration) {
+            decelJerkTime = std::sqrt((maxVelocity - end) / jerk);
+            decelTime = 2 * decelJerkTime;
+        } else {
+            decelJerkTime = acceleration / jerk;
+            decelTime = decelJerkTime + (maxVelocity - end) / acceleration;
+        }
+        cruiseTime = length / maxVelocity - accelTime / 2 * (1 + start / maxVelocity) -
+                     decelTime / 2 * (1 + end / maxVelocity);
+
+        if (cruiseTime <= 0) {
+            // the limit is never reached; lower the acceleration until both phases reach theirs
+            cruiseTime = 0;
+            for (int i = 0; i < 1000; i++) {
+                const float jerkTime = acceleration / jerk;
+                const float a2 = acceleration * acceleration;
+                const float delta = a2 * a2 / (jerk * jerk) + 2 * (start * start + end * end) +
+                                    acceleration * (4 * length - 2 * acceleration / jerk * sum);
+                accelTime = (a2 / jerk - 2 * start + std::sqrt(delta)) / (2 * acceleration);
+                decelTime = (a2 / jerk - 2 * end + std::sqrt(delta)) / (2 * acceleration);
+                if (accelTime < 0 || decelTime < 0) break;
+                accelJerkTime = decelJerkTime = jerkTime;
+                if (accelTime >= 2 * jerkTime && decelTime >= 2 * jerkTime) break;
+                acceleration *= 0.99f;
+            }
+            // only one phase is needed: all deceleration or all acceleration
+            if (accelTime < 0) {
+                accelTime = accelJerkTime = 0;
+                decelTime = 2 * length / sum;
+                // the bisection in the constructor lands on the edge of feasible, where the root can round
+                // below 0; the profile is then all jerk, Tj = T / 2
+                decelJerkTime = (jerk * length -
+                                 std::sqrt(std::max(jerk * (jerk * length * length + sum * sum * (end - start)),
+                                                    0.0f))) /
+                                (jerk * sum);
+            } else if (decelTime < 0) {
+                decelTime = decelJerkTime = 0;
+                accelTime = 2 * length / sum;
+                accelJerkTime = (jerk * length -
+                                 std::sqrt(std::max(jerk * (jerk * length * length - sum * sum * (end - start)),
+                                                    0.0f))) /
+                                (jerk * sum);
+            }
+        }
+
+        accelLimit = jerk * accelJerkTime;
+        decelLimit = -jerk * decelJerkTime;
+        peak = start + (accelTime - accelJerkTime) * accelLimit;
+        return true;
+    }
+
+    SCurve::State SCurve::at(float t) const {
+        const float total = duration();
+        t = std::clamp(t, 0.0f, total);
+        if (t < accelJerkTime) {
+            return {start * t + jerk * t * t * t / 6, start + jerk * t * t / 2, jerk * t};
+        }
+        if (t < accelTime - accelJerkTime) {
+            const float tj = accelJerkTime;
+            return {start * t + accelLimit / 6 * (3 * t * t - 3 * tj * t + tj * tj),
+                    start + accelLimit * (t - tj / 2), accelLimit};
+        }
+        if (t < accelTime) {
+            const float left = accelTime - t;
+            return {(peak + start) * accelTime / 2 - peak * left + jerk * left * left * left / 6,
+                    peak - jerk * left * left / 2, jerk * left};
+        }
+        if (t < accelTime + cruiseTime) {
+            return {(peak + start) * accelTime / 2 + peak * (t - accelTime), peak, 0};
+        }
+        const float decelStart = total - decelTime;
+        const float since = t - decelStart;
+        const float atDecel = length - (peak + end) * decelTime / 2;
+        if (since < decelJerkTime) {
+            return {atDecel + peak * since - jerk * since * since * since / 6, peak - jerk * since * since / 2,
+                    -jerk * since};
+        }
+        if (t < total - decelJerkTime) {
+            const float tj = decelJerkTime;
+            return {atDecel + peak * since + decelLimit / 6 * (3 * since * since - 3 * tj * since + tj * tj),
+                    peak + decelLimit * (since - tj / 2), decelLimit};
+        }
+        const float left = total - t;
+        return {length - end * left - jerk * left * left * left / 6, end + jerk * left * left / 2, -jerk * left};
+    }
+
+    void planVelocity(std::vector<PathSample>& samples, ProfileLimits limits, float lateralAcceleration,
+                      float trackWidth, float startVelocity, float endVelocity) {
+        if (samples.empty()) return;
+        for (PathSample& sample : samples) {
+            sample.velocity = std::min(sample.velocity, limits.velocity);
+            const float curvature = std::fabs(sample.curvature);
+            if (curvature == 0) continue;
+            sample.velocity = std::min({sample.velocity, std::sqrt(lateralAcceleration / curvature),
+                                        limits.velocity / (1 + curvature * trackWidth / 2)});
+        }
+        samples.front().velocity = std::min(samples.front().velocity, std::max(startVelocity, 0.0f));
+        samples.back().velocity = std::min(samples.back().velocity, std::max(endVelocity, 0.0f));
+        // v^2 = v0^2 + 2ad
+        for (size_t i = 1; i < samples.size(); i++) {
+            const float step = samples[i].distance - samples[i - 1].distance;
+            const float reachable = std::sqrt(samples[i - 1].velocity * samples[i - 1].velocity +
+                                              2 * limits.acceleration * step);
+            samples[i].velocity = std::min(samples[i].velocity, reachable);
+        }
+        for (size_t i = samples.size() - 1; i > 0; i--) {
+            const float step = samples[i].distance - samples[i - 1].distance;
+            const float stoppable = std::sqrt(samples[i].velocity * samples[i].velocity +
+                                              2 * limits.acceleration * step);
+            samples[i - 1].velocity = std::min(samples[i - 1].velocity, stoppable);
+        }
+    }
+}
@@ -0,0 +1,322 @@
+#include "odometry.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace robot {
+    Odometry::Odometry(OdometrySensors sensors, OdometryNoise noise, float gyroSign)
+        : sensors(sensors),
+          noise(noise),
+          gyroSign(gyroSign) {}
+
+    void Odometry::start(uint32_t period) {
+        sensors.imu->reset(true);
+        sensors.imu->set_data_rate(period);
+        sensors.vertical->reset();
+        sensors.left->reset();
+        sensors.right->reset();
+        lastVertical = sensors.vertical->getDistanceTraveled();
+        lastLeft = sensors.left->getDistanceTraveled();
+        lastRight = sensors.right->getDistanceTraveled();
+        // the speeds start unknown, the pose wherever setPose puts it
+        covariance[3][3] = noise.acceleration * noise.acceleration;
+        covariance[4][4] = noise.angularAcceleration * noise.angularAcceleration;
+        setPose(lemlib::Pose(0, 0, 0));
+
+        pros::Task task([this, period]() {
+            uint32_t now = pros::millis();
+            uint64_t last = pros::micros();
+            while (true) {
+                pros::Task::delay_until(&now, period);
+                const uint64_t time = pros::micros();
+                const float dt = (time - last) / 1e6f;
+                last = time;
+                if (dt <= 0) continue;
+                mutex.take();
+                // the motors only report every 10 ms
+                driveTime += dt;
+                const bool readDrive = driveTime >= 0.0095f;
+                update(dt, readDrive);
+                if (readDrive) driveTime = 0;
+                // the GPS reports every 20 ms
+                gpsTime += dt;
+                if (gps != nullptr && gpsTime >= 0.0195f) {
+                    correctGps();
+                    gpsTime = 0;
+                }
+                history[historyEnd++ % history.size()] = {pros::millis(), state[0], state[1], state[2]};
+                publish();
+                mutex.give();
+            }
+        }, "Odometry");
+    }
+
+    void Odometry::predict(float dt, float distance) {
+        // the tracking wheel's travel moves the pose, like LemLib's odometry; differencing it into a speed
+        // and integrating that would lag half an update behind
+        const float offset = sensors.vertical->getOffset();
+        const float turn = state[4] * dt;
+        const float travel = distance + offset * turn;
+        const float middle = state[2] + turn / 2;
+        state[0] += travel * std::sin(middle);
+        state[1] += travel * std::cos(middle);
+        state[2] += turn;
+
+        Matrix jacobian {};
+        for (int i = 0; i < STATES; i++) jacobian[i][i] = 1;
+        jacobian[0][2] = travel * std::cos(middle);
+        jacobian[0][4] = offset * dt * std::sin(middle) + travel * std::cos(middle) * dt / 2;
+        jacobian[1][2] = -travel * std::sin(middle);
+        jacobian[1][4] = offset * dt * std::cos(middle) - travel * std::sin(middle) * dt / 2;
+        jacobian[2][4] = dt;
+
+        // P = F P F^T
+        Matrix product {};
+        for (int i = 0; i < STATES; i++) {
+            for (int j = 0; j < STATES; j++) {
+                for (int k = 0; k < STATES; k++) product[i][j] += jacobian[i][k] * covariance[k][j];
+            }
+        }
+        for (int i = 0; i < STATES; i++) {
+            for (int j = 0; j < STATES; j++) {
+                covariance[i][j] = 0;
+                for (int k = 0; k < STATES; k++) covariance[i][j] += product[i][k] * jacobian[j][k];
+            }
+        }
+
+        // + Q: the wheel's error along the heading, drift growing with the distance driven, and white noise
+        // accelerations forwards and turning
+        const float drift = noise.drift * noise.drift / 100 * std::fabs(travel);
+        covariance[0][0] += drift;
+        covariance[1][1] += drift;
+        const Vector wheel {std::sin(middle), std::cos(middle), 0, 0, 0};
+        const Vector forward {0, 0, 0, 1, 0};
+        const Vector turning {0, 0, dt / 2, 0, 1};
+        const float w = noise.trackingWheel * noise.trackingWheel * dt * dt;
+        const float a = noise.acceleration * noise.acceleration * dt * dt;
+        const float alpha = noise.angularAcceleration * noise.angularAcceleration * dt * dt;
+        for (int i = 0; i < STATES; i++) {
+            for (int j = 0; j < STATES; j++) {
+                covariance[i][j] += w * wheel[i] * wheel[j] + a * forward[i] * forward[j] + alpha * turning[i] * turning[j];
+            }
+        }
+        const float imuDrift = lemlib::degToRad(noise.imuDrift);
+        covariance[5][5] += imuDrift * imuDrift / 60 * dt;
+    }
+
+    void Odometry::correct(const Vector& h, float z, float variance) {
+        Vector ph {}; // P h^T
+        float predicted = 0;
+        for (int i = 0; i < STATES; i++) {
+            for (int j = 0; j < STATES; j++) ph[i] += covariance[i][j] * h[j];
+            predicted += h[i] * state[i];
+        }
+        float innovationVariance = variance;
+        for (int i = 0; i < STATES; i++) innovationVariance += h[i] * ph[i];
+        if (innovationVariance <= 0) return;
+
+        const float innovation = z - predicted;
+        for (int i = 0; i < STATES; i++) state[i] += ph[i] / innovationVariance * innovation;
+        // P -= K h P, with K = P h^T / s; P is symmetric so h P = (P h^T)^T
+        for (int i = 0; i < STATES; i++) {
+            for (int j = 0; j < STATES; j++) covariance[i][j] -= ph[i] * ph[j] / innovationVariance;
+        }
+    }
+
+    void Odometry::update(float dt, bool readDrive) {
+        const float vertical = sensors.vertical->getDistanceTraveled();
+        predict(dt, vertical - lastVertical);
+
+        const float heading = lemlib::degToRad(sensors.imu->get_rotation()) + headingOffset;
+        // the IMU reads the heading plus its drift
+        correct({0, 0, 1, 0, 0, 1}, heading, noise.imuHeading * noise.imuHeading);
+        const float gyro = gyroSign * lemlib::degToRad(sensors.imu->get_gyro_rate().z);
+        correct({0, 0, 0, 0, 1}, gyro, noise.gyroRate * noise.gyroRate);
+
+        // a wheel offset to the right (positive) moves at v - omega * offset while turning clockwise
+        correct({0, 0, 0, 1, -sensors.vertical->getOffset()}, (vertical - lastVertical) / dt,
+                noise.trackingWheel * noise.trackingWheel);
+        lastVertical = vertical;
+
+        if (!readDrive) return;
+        const float left = sensors.left->getDistanceTraveled();
+        const float right = sensors.right->getDistanceTraveled();
+        const float leftSpeed = (left - lastLeft) / driveTime;
+        const float rightSpeed = (right - lastRight) / driveTime;
+        lastLeft = left;
+        lastRight = right;
+
+        // gate both sides together on their normalised innovation squared, y^T S^-1 y
+        const Vector hLeft {0, 0, 0, 1, -sensors.left->getOffset()};
+        const Vector hRight {0, 0, 0, 1, -sensors.right->getOffset()};
+        const float variance = noise.driveEncoder * noise.driveEncoder;
+        float s[2][2] = {{variance, 0}, {0, variance}};
+        float y[2] = {leftSpeed, rightSpeed};
+        const Vector* h[2] = {&hLeft, &hRight};
+        for (int m = 0; m < 2; m++) {
+            for (int i = 0; i < STATES; i++) {
+                y[m] -= (*h[m])[i] * state[i];
+                for (int n = 0; n < 2; n++) {
+                    for (int j = 0; j < STATES; j++) s[m][n] += (*h[m])[i] * covariance[i][j] * (*h[n])[j];
+                }
+            }
+        }
+        const float determinant = s[0][0] * s[1][1] - s[0][1] * s[1][0];
+        if (determinant <= 0) return;
+        const float nis =
+            (y[0] * y[0] * s[1][1] - 2 * y[0] * y[1] * s[0][1] + y[1] * y[1] * s[0][0]) / determinant;
+        const bool slip = nis > noise.slipGate;
+        if (slip && !slipping) slipCount++;
+        slipping = slip;
+        if (slip) return;
+        correct(hLeft, leftSpeed, variance);
+        correct(hRight, rightSpeed, variance);
+    }
+
+    void Odometry::publish() {
+        lemlib::setPose(lemlib::Pose(state[0], state[1], state[2]), true);
+    }
+
+    void Odometry::setPose(lemlib::Pose pose) {
+        mutex.take();
+        state[0] = pose.x;
+        state[1] = pose.y;
+        state[2] = lemlib::degToRad(pose.theta);
+        headingOffset = state[2] - lemlib::degToRad(sensors.imu->get_rotation());
+        state[5] = 0;
+        // keep the speeds, forget how unsure the pose and IMU drift were
+        for (int i : {0, 1, 2, 5}) {
+            for (int j = 0; j < STATES; j++) {
+                covariance[i][j] = 0;
+                covariance[j][i] = 0;
+            }
+        }
+        publish();
+        mutex.give();
+    }
+
+    void Odometry::correctX(float x, float deviation) {
+        mutex.take();
+        correct({1, 0, 0, 0, 0}, x, deviation * deviation);
+        publish();
+        mutex.give();
+    }
+
+    void Odometry::correctY(float y, float deviation) {
+        mutex.take();
+        correct({0, 1, 0, 0, 0}, y, deviation * deviation);
+        publish();
+        mutex.give();
+    }
+
+    void Odometry::setGps(pros::Gps* gps, GpsSettings settings) {
+        mutex.take();
+        this->gps = gps;
+        gpsSettings = settings;
+        mutex.give();
+    }
+
+    pros::Gps* Odometry::getGps() {
+        mutex.take();
+        pros::Gps* const current = gps;
+        mutex.give();
+        return current;
+    }
+
+    void Odometry::correctGps() {
+        const double error = gps->get_error();
+        const double gpsX = gps->get_position_x();
+        const double gpsY = gps->get_position_y();
+        const double gpsHeading = gps->get_heading();
+        // PROS_ERR_F (infinity) when unplugged
+        if (!std::isfinite(error) || !std::isfinite(gpsX) || !std::isfinite(gpsY) || !std::isfinite(gpsHeading)) return;
+        const float deviation = std::fmax(error / 0.0254, 0.1f);
+        if (deviation > gpsSettings.maxError) return;
+
+        // the estimate when the reading was taken, or the oldest one kept
+        const uint32_t taken = pros::millis() - gpsSettings.latency;
+        Past past {pros::millis(), state[0], state[1], state[2]};
+        for (size_t i = 1; i <= std::min(historyEnd, history.size()); i++) {
+            past = history[(historyEnd - i) % history.size()];
+            if (int32_t(past.time - taken) <= 0) break;
+        }
+
+        // metres in the GPS's frame to inches in ours, then on by how far the robot moved since
+        const float rotation = lemlib::degToRad(gpsSettings.rotation);
+        const float gpsXInches = gpsX / 0.0254;
+        const float gpsYInches = gpsY / 0.0254;
+        const float x = gpsXInches * std::cos(rotation) + gpsYInches * std::sin(rotation) + state[0] - past.x;
+        const float y = -gpsXInches * std::sin(rotation) + gpsYInches * std::cos(rotation) + state[1] - past.y;
+        float heading = lemlib::degToRad(gpsHeading) + rotation + state[2] - past.theta;
+        // the GPS heading wraps at 360, the estimate doesn't
+        heading = state[2] + std::remainder(heading - state[2], 2 * M_PI);
+
+        // gate x, y and heading together on their normalised innovation squared, y^T S^-1 y
+        const float headingDeviation = lemlib::degToRad(gpsSettings.headingDeviation);
+        const float innovation[3] = {x - state[0], y - state[1], heading - state[2]};
+        const float noise[3] = {deviation * deviation, deviation * deviation, headingDeviation * headingDeviation};
+        float s[3][3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) s[i][j] = covariance[i][j] + (i == j ? noise[i] : 0);
+        }
+        // adjugate of the symmetric S
+        const float a00 = s[1][1] * s[2][2] - s[1][2] * s[2][1];
+        const float a01 = s[0][2] * s[2][1] - s[0][1] * s[2][2];
+        const float a02 = s[0][1] * s[1][2] - s[0][2] * s[1][1];
+        const float a11 = s[0][0] * s[2][2] - s[0][2] * s[2][0];
+        const float a12 = s[0][2] * s[1][0] - s[0][0] * s[1][2];
+        const float a22 = s[0][0] * s[1][1] - s[0][1] * s[1][0];
+        const float determinant = s[0][0] * a00 + s[0][1] * (s[1][2] * s[2][0] - s[1][0] * s[2][2]) +
+                                  s[0][2] * (s[1][0] * s[2][1] - s[1][1] * s[2][0]);
+        if (determinant <= 0) return;
+        const float* v = innovation;
+        const float nis = (v[0] * v[0] * a00 + v[1] * v[1] * a11 + v[2] * v[2] * a22 +
+                           2 * (v[0] * v[1] * a01 + v[0] * v[2] * a02 + v[1] * v[2] * a12)) /
+                          determinant;
+        if (nis > gpsSettings.gate) {
+            gpsRejected++;
+            return;
+        }
+
+        correct({1, 0, 0, 0, 0}, x, noise[0]);
+        correct({0, 1, 0, 0, 0}, y, noise[1]);
+        correct({0, 0, 1, 0, 0}, heading, noise[2]);
+    }
+
+    lemlib::Pose Odometry::getPose(bool radians) {
+        mutex.take();
+        const lemlib::Pose pose(state[0], state[1], radians ? state[2] : lemlib::radToDeg(state[2]));
+        mutex.give();
+        return pose;
+    }
+
+    PoseCovariance Odometry::getCovariance() {
+        PoseCovariance pose;
+        mutex.take();
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) pose[i][j] = covariance[i][j];
+        }
+        mutex.give();
+        return pose;
+    }
+
+    bool Odometry::isSlipping() {
+        mutex.take();
+        const bool slip = slipping;
+        mutex.give();
+        return slip;
+    }
+
+    uint32_t Odometry::getSlipCount() {
+        mutex.take();
+        const uint32_t count = slipCount;
+        mutex.give();
+        return count;
+    }
+
+    uint32_t Odometry::getGpsRejected() {
+        mutex.take();
+        const uint32_t count = gpsRejected;
+        mutex.give();
+        return count;
+    }
+}
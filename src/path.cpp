@@ -0,0 +1,56 @@
+#include "path.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace robot::path {
+    PathView::PathView(const asset& path)
+        : header(reinterpret_cast<const Header*>(path.buf)),
+          points(reinterpret_cast<const Waypoint*>(path.buf + sizeof(Header))) {}
+
+    int PathView::closest(float x, float y, float window) {
+        const float end = points[closestCursor].distance + window;
+        int best = closestCursor;
+        float bestDist = std::hypot(points[best].x - x, points[best].y - y);
+        for (int i = closestCursor + 1; i < size() && points[i].distance <= end; i++) {
+            const float dist = std::hypot(points[i].x - x, points[i].y - y);
+            if (dist < bestDist) {
+                bestDist = dist;
+                best = i;
+            }
+        }
+        closestCursor = best;
+        return best;
+    }
+
+    bool PathView::lookahead(float x, float y, float radius, int closest, float& targetX, float& targetY) {
+        for (int i = std::max(closest, lookaheadCursor); i < size() - 1; i++) {
+            const Waypoint& p1 = points[i];
+            const Waypoint& p2 = points[i + 1];
+            const float dx = p2.x - p1.x;
+            const float dy = p2.y - p1.y;
+            const float fx = p1.x - x;
+            const float fy = p1.y - y;
+            const float a = dx * dx + dy * dy;
+            if (a == 0) continue;
+            const float b = 2 * (fx * dx + fy * dy);
+            const float c = fx * fx + fy * fy - radius * radius;
+            float discriminant = b * b - 4 * a * c;
+            if (discriminant < 0) continue;
+            discriminant = std::sqrt(discriminant);
+            // prefer the intersection further along the path
+            float t = (-b + discriminant) / (2 * a);
+            if (t < 0 || t > 1) t = (-b - discriminant) / (2 * a);
+            if (t < 0 || t > 1) continue;
+            targetX = p1.x + dx * t;
+            targetY = p1.y + dy * t;
+            lookaheadCursor = i;
+            return true;
+        }
+        return false;
+    }
+
+    void PathView::reset() {
+        closestCursor = 0;
+        lookaheadCursor = 0;
+    }
+}
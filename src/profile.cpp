@@ -0,0 +1,87 @@
+#include "profile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef PROFILE
+namespace {
+    robot::profile::Region regions[robot::profile::MAX_REGIONS];
+    int count = 0;
+    pros::Mutex mutex; // only taken when a region is added
+
+    int bucket(uint32_t us) {
+        if (us < 16) return us;
+        const int msb = 31 - __builtin_clz(us);
+        if (msb >= 24) return robot::profile::BUCKETS - 1;
+        return 16 + (msb - 4) * 8 + ((us >> (msb - 3)) & 7);
+    }
+
+    // largest value that falls in the bucket
+    uint32_t upperEdge(int bucket) {
+        if (bucket < 16) return bucket;
+        const int msb = 4 + (bucket - 16) / 8;
+        const uint32_t step = 1u << (msb - 3);
+        return (8 + (bucket - 16) % 8) * step + step - 1;
+    }
+}
+
+namespace robot::profile {
+    void Region::add(uint32_t us) {
+        count++;
+        min = std::min(min, us);
+        max = std::max(max, us);
+        total += us;
+        histogram[bucket(us)]++;
+    }
+
+    uint32_t Region::mean() const { return count == 0 ? 0 : total / count; }
+
+    uint32_t Region::p99() const {
+        const uint32_t rank = count - count / 100; // samples at or below the 99th percentile
+        uint32_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += histogram[i];
+            if (seen >= rank && seen > 0) return std::min(upperEdge(i), max);
+        }
+        return max;
+    }
+
+    void Region::reset() {
+        const char* keep = name;
+        *this = Region();
+        name = keep;
+    }
+
+    Region* region(const char* name) {
+        mutex.take();
+        Region* found = nullptr;
+        for (int i = 0; i < count && found == nullptr; i++) {
+            if (std::strcmp(regions[i].name, name) == 0) found = &regions[i];
+        }
+        if (found == nullptr && count < MAX_REGIONS) {
+            found = &regions[count++];
+            found->name = name;
+        }
+        mutex.give();
+        return found;
+    }
+
+    int regionCount() { return count; }
+
+    Region& regionAt(int index) { return regions[index]; }
+
+    void print() {
+        std::printf("%-16s %8s %8s %8s %8s %8s  (us)\n", "region", "runs", "min", "mean", "p99", "max");
+        for (int i = 0; i < count; i++) {
+            const Region& region = regions[i];
+            std::printf("%-16s %8lu %8lu %8lu %8lu %8lu\n", region.name, (unsigned long)region.count,
+                        (unsigned long)(region.count == 0 ? 0 : region.min), (unsigned long)region.mean(),
+                        (unsigned long)region.p99(), (unsigned long)region.max);
+        }
+    }
+
+    void reset() {
+        for (int i = 0; i < count; i++) regions[i].reset();
+    }
+}
+#endif
@@ -0,0 +1,109 @@
+#include "relocalize.hpp"
+#include <cmath>
+
+namespace robot {
+    Relocalizer::Relocalizer(std::vector<WallSensor> sensors, RelocalizeSettings settings, Chassis* chassis,
+                             Odometry* odometry)
+        : sensors(std::move(sensors)),
+          settings(settings),
+          chassis(chassis),
+          odometry(odometry) {}
+
+    bool Relocalizer::read(const WallSensor& wall, const lemlib::Pose& pose, Reading& reading) {
+        const int32_t millimetres = wall.sensor->get_distance();
+        // PROS_ERR when unplugged, 9999 when nothing is in range
+        if (millimetres <= 0 || millimetres >= 9999) return false;
+        const float measured = millimetres / 25.4f;
+        if (measured > settings.maxRange) return false;
+        if (millimetres > 200 && wall.sensor->get_confidence() < settings.minConfidence) return false;
+
+        // where the sensor is and which way it points, heading clockwise from +y
+        const float sinHeading = std::sin(pose.theta);
+        const float cosHeading = std::cos(pose.theta);
+        const float sensorX = pose.x + wall.x * cosHeading + wall.y * sinHeading;
+        const float sensorY = pose.y - wall.x * sinHeading + wall.y * cosHeading;
+        const float beam = pose.theta + lemlib::degToRad(wall.angle);
+        const float dx = std::sin(beam);
+        const float dy = std::cos(beam);
+
+        // at most one wall is within maxIncidence (< 45 deg) of square to the beam
+        const float square = std::cos(lemlib::degToRad(settings.maxIncidence));
+        const float limit = settings.wallDistance - settings.cornerMargin;
+        float expected;
+        if (std::fabs(dx) >= square) {
+            expected = (std::copysign(settings.wallDistance, dx) - sensorX) / dx;
+            if (std::fabs(sensorY + expected * dy) > limit) return false;
+            reading.xAxis = true;
+        } else if (std::fabs(dy) >= square) {
+            expected = (std::copysign(settings.wallDistance, dy) - sensorY) / dy;
+            if (std::fabs(sensorX + expected * dx) > limit) return false;
+            reading.xAxis = false;
+        } else {
+            return false;
+        }
+        if (expected <= 0) return false;
+
+        const float residual = measured - expected;
+        if (std::fabs(residual) > settings.outlierGate) {
+            rejected++;
+            return false;
+        }
+        // move the pose along the beam until the sensor sits the measured distance from the wall
+        reading.value = reading.xAxis ? pose.x - residual * dx : pose.y - residual * dy;
+        // the sensor is good to 15 mm, or 5% past 300 mm
+        reading.deviation = std::fmax(15.0f, 0.05f * millimetres) / 25.4f;
+        return true;
+    }
+
+    int Relocalizer::relocalize() {
+        const lemlib::Pose pose = odometry != nullptr ? odometry->getPose(true) : chassis->getPose(true);
+        float sumX = 0;
+        float sumY = 0;
+        int countX = 0;
+        int countY = 0;
+        mutex.take();
+        for (const WallSensor& wall : sensors) {
+            Reading reading;
+            if (!read(wall, pose, reading)) continue;
+            if (odometry != nullptr) {
+                if (reading.xAxis) odometry->correctX(reading.value, reading.deviation);
+                else odometry->correctY(reading.value, reading.deviation);
+            }
+            if (reading.xAxis) {
+                sumX += reading.value;
+                countX++;
+            } else {
+                sumY += reading.value;
+                countY++;
+            }
+        }
+        mutex.give();
+
+        if (odometry == nullptr && countX + countY > 0) {
+            chassis->setPose(countX > 0 ? sumX / countX : pose.x, countY > 0 ? sumY / countY : pose.y, pose.theta,
+                             true);
+        }
+        return countX + countY;
+    }
+
+    void Relocalizer::start(uint32_t period) {
+        // without the filter each correction would be a setPose racing LemLib's odometry
+        if (odometry == nullptr) return;
+        pros::Task task([this, period]() {
+            uint32_t now = pros::millis();
+            while (true) {
+                if (enabled) relocalize();
+                pros::Task::delay_until(&now, period);
+            }
+        }, "Relocalize");
+    }
+
+    void Relocalizer::setEnabled(bool enabled) { this->enabled = enabled; }
+
+    uint32_t Relocalizer::getRejected() {
+        mutex.take();
+        const uint32_t count = rejected;
+        mutex.give();
+        return count;
+    }
+}
@@ -0,0 +1,127 @@
+#include "ringsensor.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace robot {
+    RingSensor::RingSensor(pros::Optical* optical, pros::Motor* intake, bool reversed,
+                           std::vector<RingCalibration> colors, std::vector<HueWindow> hues,
+                           RingSensorSettings settings)
+        : optical(optical),
+          intake(intake),
+          direction(reversed ? -1 : 1),
+          colors(std::move(colors)),
+          hues(std::move(hues)),
+          settings(settings) {}
+
+    RingColor RingSensor::classify(const pros::c::optical_rgb_s_t& rgb) const {
+        const double sum = rgb.red + rgb.green + rgb.blue;
+        // PROS_ERR_F when unplugged
+        if (!std::isfinite(sum) || sum <= 0) return RingColor::NONE;
+        RingColor nearest = RingColor::NONE;
+        double best = settings.maxDistance;
+        for (const RingCalibration& color : colors) {
+            const double distance = std::hypot(rgb.red / sum - color.red, rgb.green / sum - color.green,
+                                               rgb.blue / sum - color.blue);
+            if (distance <= best) {
+                best = distance;
+                nearest = color.color;
+            }
+        }
+        return nearest;
+    }
+
+    RingColor RingSensor::classify(double hue) const {
+        for (const HueWindow& window : hues) {
+            if (hue >= window.min && hue <= window.max) return window.color;
+        }
+        return RingColor::NONE;
+    }
+
+    void RingSensor::sample() {
+        const uint64_t now = pros::micros();
+        RingColor color = RingColor::NONE;
+        if (colors.empty()) {
+            color = classify(optical->get_hue());
+        } else {
+            const int32_t proximity = optical->get_proximity();
+            if (proximity != PROS_ERR && proximity >= settings.minProximity) color = classify(optical->get_rgb());
+        }
+        const double travel = direction * intake->get_position();
+        const double advance = started ? travel - lastTravel : 0;
+        lastTravel = travel;
+        started = true;
+
+        mutex.take();
+        samples++;
+        if (color == RingColor::NONE) skipped++;
+        // a ring run back down out of view comes past again as a new one
+        if (travel < edge) seeing = RingColor::NONE;
+        bool found = false;
+        if (color != RingColor::NONE && color != seeing) {
+            // it came into view somewhere since the last sample, split the difference
+            edge = travel - std::max(advance, 0.0) / 2;
+            found = true;
+        } else if (color != RingColor::NONE && travel - edge >= settings.ringLength) {
+            // rings touching each other read as one long ring
+            edge += settings.ringLength;
+            found = true;
+        }
+        seeing = color;
+        if (found) {
+            // the sort only needs the newest rings; drop the oldest if nothing is reading the queue
+            if (count == CAPACITY) {
+                first = (first + 1) % CAPACITY;
+                count--;
+                dropped++;
+            }
+            queue[(first + count) % CAPACITY] = {now, edge, color};
+            count++;
+        }
+        mutex.give();
+    }
+
+    bool RingSensor::pop(RingDetection& detection) {
+        mutex.take();
+        const bool any = count > 0;
+        if (any) {
+            detection = queue[first];
+            first = (first + 1) % CAPACITY;
+            count--;
+        }
+        mutex.give();
+        return any;
+    }
+
+    void RingSensor::start(uint32_t period) {
+        // gesture detection slows the color readings down
+        optical->disable_gesture();
+        pros::Task task([this, period]() {
+            uint32_t now = pros::millis();
+            while (true) {
+                sample();
+                pros::Task::delay_until(&now, period);
+            }
+        }, "Ring sensor");
+    }
+
+    uint32_t RingSensor::getSamples() {
+        mutex.take();
+        const uint32_t value = samples;
+        mutex.give();
+        return value;
+    }
+
+    uint32_t RingSensor::getSkipped() {
+        mutex.take();
+        const uint32_t value = skipped;
+        mutex.give();
+        return value;
+    }
+
+    uint32_t RingSensor::getDropped() {
+        mutex.take();
+        const uint32_t value = dropped;
+        mutex.give();
+        return value;
+    }
+}
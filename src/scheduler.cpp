@@ -0,0 +1,128 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    void printJob(const robot::telemetry::Record& record, FILE* file) {
+        const float* field = record.fields;
+        std::fprintf(file, "%-12s %4lums %6lu runs %6lu overruns, max jitter %6luus, mean run %6luus\n",
+                     robot::telemetry::lookup(field[0]), (unsigned long)field[1], (unsigned long)field[2],
+                     (unsigned long)field[3], (unsigned long)field[4], (unsigned long)field[5]);
+    }
+
+    // histogram buckets: <=100, 250, 500, 1k, 2k, 5k, 10k us and above
+    void printHistogram(const robot::telemetry::Record& record, FILE* file) {
+        std::fprintf(file, "%-12s %s (us) <=100 250 500 1k 2k 5k 10k more:", robot::telemetry::lookup(record.fields[0]),
+                     record.type == robot::telemetry::JOB_JITTER ? "jitter" : "period");
+        for (int i = 1; i < record.count; i++) std::fprintf(file, " %lu", (unsigned long)record.fields[i]);
+        std::fputc('\n', file);
+    }
+}
+
+namespace robot {
+    Scheduler::Scheduler(uint32_t tick, uint32_t reportPeriod)
+        : tick(std::max<uint32_t>(tick, 1)),
+          reportPeriod(reportPeriod) {
+        telemetry::setFormatter(telemetry::JOB, printJob);
+        telemetry::setFormatter(telemetry::JOB_JITTER, printHistogram);
+        telemetry::setFormatter(telemetry::JOB_PERIOD, printHistogram);
+    }
+
+    void Scheduler::add(const char* name, uint32_t period, int priority, std::function<void()> job) {
+        period = std::max(tick, (period + tick - 1) / tick * tick);
+        jobs.push_back({name, telemetry::intern(name), period, priority, std::move(job)});
+        // stable, so jobs of equal priority keep the order they were added in
+        std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.priority > b.priority; });
+    }
+
+    int Scheduler::bucket(uint32_t us) {
+        int i = 0;
+        while (i < BUCKETS - 1 && us > BUCKET_EDGES[i]) i++;
+        return i;
+    }
+
+    void Scheduler::run(std::function<bool()> condition) {
+        uint32_t now = pros::millis();
+        for (Job& job : jobs) {
+            job.nextRun = now;
+            job.lastStart = NEVER;
+        }
+        uint32_t nextReport = now + reportPeriod;
+
+        while (condition()) {
+            for (Job& job : jobs) {
+                if (int32_t(pros::millis() - job.nextRun) < 0) continue;
+
+                const uint64_t start = pros::micros();
+                const uint32_t jitter = start - uint64_t(job.nextRun) * 1000;
+                Stats& stats = job.stats;
+                stats.jitterHistogram[bucket(jitter)]++;
+                stats.maxJitter = std::max(stats.maxJitter, jitter);
+                if (job.lastStart != NEVER) {
+                    const int64_t deviation = int64_t(start - job.lastStart) - int64_t(job.period) * 1000;
+                    stats.periodHistogram[bucket(std::llabs(deviation))]++;
+                }
+                job.lastStart = start;
+
+                job.function();
+
+                const uint32_t runtime = pros::micros() - start;
+                stats.runs++;
+                stats.totalRuntime += runtime;
+                stats.maxRuntime = std::max(stats.maxRuntime, runtime);
+
+                job.nextRun += job.period;
+                // a job that fell a whole period behind skips ahead instead of running back to back
+                const uint32_t after = pros::millis();
+                if (int32_t(after - job.nextRun) >= int32_t(job.period)) {
+                    const uint32_t missed = (after - job.nextRun) / job.period;
+                    stats.overruns += missed;
+                    job.nextRun += missed * job.period;
+                }
+            }
+            if (reporting && reportPeriod > 0 && int32_t(pros::millis() - nextReport) >= 0) {
+                report();
+                nextReport += reportPeriod;
+            }
+            pros::Task::delay_until(&now, tick);
+        }
+    }
+
+    void Scheduler::start(const char* name, std::function<bool()> condition) {
+        telemetry::log().add(reports);
+        reporting = true;
+        pros::Task task([this, condition]() {
+            run(condition);
+            report();
+        }, name);
+    }
+
+    const Scheduler::Stats& Scheduler::stats(const char* name) const {
+        for (const Job& job : jobs) {
+            if (std::strcmp(job.name, name) == 0) return job.stats;
+        }
+        static const Stats empty;
+        return empty;
+    }
+
+    void Scheduler::report() {
+        static_assert(BUCKETS + 1 <= telemetry::MAX_FIELDS, "a histogram and its job's name go in one record");
+        for (const Job& job : jobs) {
+            const Stats& stats = job.stats;
+            const float name = job.nameId;
+            reports.push(telemetry::JOB, {name, float(job.period), float(stats.runs), float(stats.overruns),
+                                          float(stats.maxJitter),
+                                          float(stats.runs > 0 ? stats.totalRuntime / stats.runs : 0)});
+            telemetry::Record jitter = {uint32_t(pros::micros()), telemetry::JOB_JITTER, BUCKETS + 1, {name}};
+            telemetry::Record period = {jitter.time, telemetry::JOB_PERIOD, BUCKETS + 1, {name}};
+            for (int i = 0; i < BUCKETS; i++) {
+                jitter.fields[i + 1] = stats.jitterHistogram[i];
+                period.fields[i + 1] = stats.periodHistogram[i];
+            }
+            reports.push(jitter);
+            reports.push(period);
+        }
+    }
+}
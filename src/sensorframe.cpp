@@ -0,0 +1,60 @@
+#include "sensorframe.hpp"
+#include "config.hpp"
+#include "profile.hpp"
+
+namespace {
+    // the buttons the opcontrol handlers use
+    constexpr pros::controller_digital_e_t BUTTONS[] = {
+        pros::E_CONTROLLER_DIGITAL_L1, pros::E_CONTROLLER_DIGITAL_L2, pros::E_CONTROLLER_DIGITAL_R1,
+        pros::E_CONTROLLER_DIGITAL_R2, pros::E_CONTROLLER_DIGITAL_UP, pros::E_CONTROLLER_DIGITAL_DOWN,
+        pros::E_CONTROLLER_DIGITAL_LEFT, pros::E_CONTROLLER_DIGITAL_RIGHT, pros::E_CONTROLLER_DIGITAL_X,
+        pros::E_CONTROLLER_DIGITAL_B, pros::E_CONTROLLER_DIGITAL_Y
+    };
+}
+
+namespace robot {
+    SensorFrame::Counters SensorFrame::totals;
+
+    void SensorFrame::sample() {
+        PROFILE_SCOPE("frame");
+        sampledAt = pros::micros();
+
+        leftY = read(masterController.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y));
+        rightX = read(masterController.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X));
+        const uint32_t previous = buttons;
+        buttons = 0;
+        for (pros::controller_digital_e_t button : BUTTONS) {
+            if (read(masterController.get_digital(button))) buttons |= bit(button);
+        }
+        newPresses = buttons & ~previous;
+
+        intakePositionValue = read(mechanisms::intakeMotor.get_position());
+        lbPositionValue = read(mechanisms::lbRotationSensor.get_position());
+        lbVelocityValue = read(mechanisms::lbMotor.get_actual_velocity());
+
+        totals.frames++;
+    }
+
+    uint32_t SensorFrame::bit(pros::controller_digital_e_t button) const {
+        // the digital channels are numbered from E_CONTROLLER_DIGITAL_L1
+        return 1u << (button - pros::E_CONTROLLER_DIGITAL_L1);
+    }
+
+    int SensorFrame::analog(pros::controller_analog_e_t channel) const {
+        switch (channel) {
+            case pros::E_CONTROLLER_ANALOG_LEFT_Y: return handOut(leftY);
+            case pros::E_CONTROLLER_ANALOG_RIGHT_X: return handOut(rightX);
+            default: return 0; // not sampled
+        }
+    }
+
+    bool SensorFrame::held(pros::controller_digital_e_t button) const { return handOut(bool(buttons & bit(button))); }
+
+    bool SensorFrame::pressed(pros::controller_digital_e_t button) const { return handOut(bool(newPresses & bit(button))); }
+
+    double SensorFrame::intakePosition() const { return handOut(intakePositionValue); }
+
+    double SensorFrame::lbPosition() const { return handOut(lbPositionValue); }
+
+    double SensorFrame::lbVelocity() const { return handOut(lbVelocityValue); }
+}
@@ -0,0 +1,86 @@
+#include "telemetry.hpp"
+
+namespace {
+    // both written at setup and read by the drainer task
+    std::atomic<robot::telemetry::Formatter> formatters[robot::telemetry::MAX_TYPES] = {};
+    std::atomic<const char*> names[robot::telemetry::MAX_NAMES] = {};
+}
+
+namespace robot::telemetry {
+    Drainer::Drainer(std::function<void(const Record&)> sink)
+        : sink(std::move(sink)) {}
+
+    bool Drainer::add(RingBase& ring) {
+        const int count = ringCount.load(std::memory_order_relaxed);
+        if (count == MAX_RINGS) return false;
+        rings[count] = &ring;
+        // the drainer only looks at the slot once the count says it is filled in
+        ringCount.store(count + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t Drainer::drain(uint32_t limit) {
+        const int ringCount = this->ringCount.load(std::memory_order_acquire);
+        uint32_t drained = 0;
+        int idle = 0; // rings in a row found empty
+        Record record;
+        while (drained < limit && idle < ringCount) {
+            RingBase& ring = *rings[next];
+            next = (next + 1) % ringCount;
+            if (!ring.pop(record)) {
+                idle++;
+                continue;
+            }
+            idle = 0;
+            sink(record);
+            drained++;
+        }
+        count += drained;
+        return drained;
+    }
+
+    uint32_t Drainer::dropped() const {
+        const int ringCount = this->ringCount.load(std::memory_order_acquire);
+        uint32_t total = 0;
+        for (int i = 0; i < ringCount; i++) total += rings[i]->dropped();
+        return total;
+    }
+
+    void setFormatter(uint16_t type, Formatter formatter) {
+        if (type < MAX_TYPES) formatters[type].store(formatter, std::memory_order_release);
+    }
+
+    void printText(const Record& record, FILE* file) {
+        if (record.type < MAX_TYPES) {
+            if (const Formatter formatter = formatters[record.type].load(std::memory_order_acquire)) {
+                formatter(record, file);
+                return;
+            }
+        }
+        std::fprintf(file, "%u,%lu", unsigned(record.type), (unsigned long)record.time);
+        for (int i = 0; i < record.count && i < MAX_FIELDS; i++) std::fprintf(file, ",%g", record.fields[i]);
+        std::fputc('\n', file);
+    }
+
+    void writeBinary(const Record& record, FILE* file) { std::fwrite(&record, sizeof(record), 1, file); }
+
+    uint16_t intern(const char* text) {
+        for (int i = 0; i < MAX_NAMES; i++) {
+            const char* expected = nullptr;
+            // claims the first free slot, or finds the one text already has
+            if (names[i].compare_exchange_strong(expected, text) || expected == text) return i + 1;
+        }
+        return 0;
+    }
+
+    const char* lookup(float id) {
+        const int index = int(id) - 1;
+        const char* text = index >= 0 && index < MAX_NAMES ? names[index].load() : nullptr;
+        return text != nullptr ? text : "?";
+    }
+
+    Drainer& log() {
+        static Drainer drainer([](const Record& record) { printText(record); });
+        return drainer;
+    }
+}
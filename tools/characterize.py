@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Fit the drive feedforward to a characterization run (robot::characterizeDrive).
+
+    characterize.py characterize.csv
+
+Fits voltage = kS * sign(velocity) + kV * velocity + kA * acceleration over the
+quasistatic and dynamic tests together by ordinary least squares, leaving out
+the samples where the drive has not started moving. The gains are printed in
+volts and in motor units (127 = 12 V), the units of the KS, KV and KA
+constants in include/drive.hpp.
+"""
+import csv
+import math
+import sys
+
+MIN_VELOCITY = 0.5  # in/s, slower samples are static friction, not motion
+MOTOR_UNITS = 127 / 12  # per volt
+
+
+def read(path):
+    rows = []
+    with open(path, newline="", encoding="utf-8") as source:
+        for row in csv.DictReader(source):
+            try:
+                rows.append((float(row["voltage"]), float(row["velocity"]), float(row["acceleration"])))
+            except (KeyError, ValueError):
+                raise SystemExit(f"{path}: expected test,time,voltage,velocity,acceleration columns")
+    return rows
+
+
+def solve(matrix, vector):
+    """Solve a small linear system by Gaussian elimination with partial pivoting."""
+    n = len(vector)
+    rows = [list(matrix[i]) + [vector[i]] for i in range(n)]
+    for column in range(n):
+        pivot = max(range(column, n), key=lambda i: abs(rows[i][column]))
+        if abs(rows[pivot][column]) < 1e-12:
+            raise SystemExit("the samples do not pin down all three gains; was the run cut short?")
+        rows[column], rows[pivot] = rows[pivot], rows[column]
+        for i in range(column + 1, n):
+            factor = rows[i][column] / rows[column][column]
+            for j in range(column, n + 1):
+                rows[i][j] -= factor * rows[column][j]
+    solution = [0.0] * n
+    for i in range(n - 1, -1, -1):
+        solution[i] = (rows[i][n] - sum(rows[i][j] * solution[j] for j in range(i + 1, n))) / rows[i][i]
+    return solution
+
+
+def fit(rows):
+    """kS, kV, kA in volts, and the r^2 and rms error of the fit."""
+    samples = [(voltage, velocity, acceleration) for voltage, velocity, acceleration in rows
+               if abs(velocity) >= MIN_VELOCITY]
+    if len(samples) < 3:
+        raise SystemExit("too few moving samples to fit")
+    features = [(math.copysign(1, velocity), velocity, acceleration) for _, velocity, acceleration in samples]
+    voltages = [voltage for voltage, _, _ in samples]
+    # normal equations X^T X k = X^T v
+    matrix = [[sum(f[i] * f[j] for f in features) for j in range(3)] for i in range(3)]
+    vector = [sum(f[i] * v for f, v in zip(features, voltages)) for i in range(3)]
+    gains = solve(matrix, vector)
+    residuals = [v - sum(g * x for g, x in zip(gains, f)) for f, v in zip(features, voltages)]
+    mean = sum(voltages) / len(voltages)
+    total = sum((v - mean) ** 2 for v in voltages)
+    squared = sum(r * r for r in residuals)
+    return gains, 1 - squared / total if total > 0 else 1.0, math.sqrt(squared / len(residuals)), len(samples)
+
+
+def main(argv):
+    if len(argv) != 2:
+        raise SystemExit(__doc__.split("\n\n")[1])
+    (ks, kv, ka), r2, rms, count = fit(read(argv[1]))
+    print(f"{count} moving samples, r^2 {r2:.4f}, rms error {rms:.3f} V")
+    print(f"kS {ks:.4f} V          {ks * MOTOR_UNITS:.3f} motor units")
+    print(f"kV {kv:.4f} V/(in/s)   {kv * MOTOR_UNITS:.3f} motor units per in/s")
+    print(f"kA {ka:.4f} V/(in/s^2) {ka * MOTOR_UNITS:.4f} motor units per in/s^2")
+    if ks < 0 or kv <= 0 or ka < 0:
+        print("warning: a gain came out negative; check the run before using these")
+    print(f"free speed at 12 V: {(12 - ks) / kv:.1f} in/s, time constant: {ka / kv * 1000:.0f} ms")
+    print()
+    print("include/drive.hpp:")
+    print(f"        constexpr float KS = {ks * MOTOR_UNITS:.2f}; // to get moving")
+    print(f"        constexpr float KV = {kv * MOTOR_UNITS:.3f}; // per in/s")
+    print(f"        constexpr float KA = {ka * MOTOR_UNITS:.3f}; // per in/s^2")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
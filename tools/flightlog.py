@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Decode a flight log written by robot::FlightLog (include/flightlog.hpp).
+
+    flightlog.py flight000.bin                    CSV to stdout
+    flightlog.py flight000.bin out.csv            CSV to a file
+    flightlog.py flight000.bin outdir --columns   one column per file, for plotting
+
+The file starts with a 12 byte little-endian header, the field names, then the
+samples back to back:
+
+    char     magic[4]     "FLOG"
+    uint16   version      1
+    uint16   sample_size  bytes per sample
+    uint16   fields       number of fields
+    uint16   period       ms between samples
+    char     names[]      `fields` NUL terminated names
+
+In version 1 the first field (time, ms) is a uint32 and the others are
+float32. --columns writes <name>.bin holding the raw little-endian values of
+each field plus schema.json listing them with their numpy dtype, so a column
+loads with numpy.fromfile(path, dtype). A trailing partial sample (the robot
+lost power mid-write) is ignored.
+"""
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"FLOG"
+HEADER = struct.Struct("<4sHHHH")
+# per version: (struct code, numpy dtype) of the first field and of the rest
+TYPES = {1: (("I", "<u4"), ("f", "<f4"))}
+
+
+def read(data):
+    if len(data) < HEADER.size:
+        raise SystemExit("file too short for a flight log header")
+    magic, version, sample_size, fields, period = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise SystemExit(f"not a flight log (magic {magic!r})")
+    if version not in TYPES:
+        raise SystemExit(f"flight log version {version} is not supported, only {sorted(TYPES)}")
+
+    offset = HEADER.size
+    names = []
+    for _ in range(fields):
+        end = data.index(b"\0", offset)
+        names.append(data[offset:end].decode("ascii"))
+        offset = end + 1
+
+    first, rest = TYPES[version]
+    codes = [first] + [rest] * (fields - 1)
+    sample = struct.Struct("<" + "".join(code for code, _ in codes))
+    if sample.size != sample_size:
+        raise SystemExit(f"sample size is {sample_size} bytes, expected {sample.size} for version {version}")
+
+    count = (len(data) - offset) // sample_size
+    rows = [sample.unpack_from(data, offset + i * sample_size) for i in range(count)]
+    return {"version": version, "period": period, "names": names, "dtypes": [dtype for _, dtype in codes]}, rows
+
+
+def write_csv(schema, rows, output):
+    output.write(",".join(schema["names"]) + "\n")
+    for row in rows:
+        output.write(",".join(str(value) if isinstance(value, int) else f"{value:.6g}" for value in row) + "\n")
+
+
+def write_columns(schema, rows, directory):
+    os.makedirs(directory, exist_ok=True)
+    for i, (name, dtype) in enumerate(zip(schema["names"], schema["dtypes"])):
+        code = "I" if dtype == "<u4" else "f"
+        with open(os.path.join(directory, name + ".bin"), "wb") as column:
+            column.write(struct.pack(f"<{len(rows)}{code}", *(row[i] for row in rows)))
+    schema = dict(schema, rows=len(rows), columns={name: name + ".bin" for name in schema["names"]})
+    with open(os.path.join(directory, "schema.json"), "w", encoding="utf-8") as file:
+        json.dump(schema, file, indent=2)
+
+
+def main(argv):
+    columns = "--columns" in argv
+    argv = [arg for arg in argv if arg != "--columns"]
+    if len(argv) not in (2, 3) or (columns and len(argv) != 3):
+        raise SystemExit(__doc__.split("\n\n")[1])
+    with open(argv[1], "rb") as file:
+        schema, rows = read(file.read())
+    if columns:
+        write_columns(schema, rows, argv[2])
+    elif len(argv) == 3:
+        with open(argv[2], "w", encoding="utf-8") as output:
+            write_csv(schema, rows, output)
+    else:
+        write_csv(schema, rows, sys.stdout)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
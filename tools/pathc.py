@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""Compile a path.jerryio export into the packed waypoint format read by include/path.hpp.
+
+    pathc.py static/Skill1.txt bin/paths/static/Skill1.path
+    pathc.py --editor-speeds static/Skill1.txt bin/paths/static/Skill1.path
+
+By default the path is rebuilt from the Bezier control points in the editor's
+#PATH.JERRYIO-DATA blob and its speeds are planned here: the fastest the drive
+can go under its velocity and acceleration limits, slowing for curves so the
+lateral acceleration and the outer wheel's speed stay in range (see plan()).
+The limits and feedforward are read from include/drive.hpp.
+With --editor-speeds, or for an export without the blob, the "x, y, speed"
+lines up to "endData" are used as drawn. The output is a 12 byte header
+followed by six little-endian floats per waypoint:
+
+    char     magic[4]   "PATH"
+    uint16   version    3
+    uint16   count      number of waypoints
+    float    length     path length in inches
+    float    x, y, speed, distance, curvature, time   (count times)
+
+speed is in motor units (0 - 127) and 0 only at the end. distance is the arc
+length from the first waypoint, curvature the signed curvature of the circle
+through the waypoint and its neighbours (1/in, positive for a clockwise turn)
+and time when the profile reaches the waypoint (seconds), so the robot does
+not have to compute them.
+"""
+import json
+import math
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"PATH"
+VERSION = 3
+BLOB = "#PATH.JERRYIO-DATA"
+
+
+def read_drive(path):
+    """The constexpr float constants of include/drive.hpp, shared with the robot's driveProfile."""
+    with open(path, encoding="utf-8") as header:
+        constants = dict(re.findall(r"constexpr float (\w+) = ([-+.\d]+);", header.read()))
+    return {name: float(value) for name, value in constants.items()}
+
+
+DRIVE = read_drive(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "drive.hpp"))
+RPM = DRIVE["RPM"]
+WHEEL_DIAMETER = DRIVE["WHEEL_DIAMETER"]  # in
+TRACK_WIDTH = DRIVE["TRACK_WIDTH"]  # in
+FREE_SPEED = RPM * math.pi * WHEEL_DIAMETER / 60  # in/s at 127
+MAX_VELOCITY = DRIVE["MAX_VELOCITY"]  # in/s
+MAX_ACCELERATION = DRIVE["MAX_ACCELERATION"]  # in/s^2
+MAX_LATERAL_ACCELERATION = DRIVE["MAX_LATERAL_ACCELERATION"]  # in/s^2
+# feedforward, turning a planned velocity and acceleration into motor units
+KS = DRIVE["KS"]
+KV = DRIVE["KV"]
+KA = DRIVE["KA"]
+RESERVE = 10  # motor units kept back from speeding up for the tracker's corrections
+SPACING = 1.0  # in between planned waypoints
+
+
+def read_waypoints(text):
+    waypoints = []
+    for number, line in enumerate(text.splitlines(), 1):
+        line = line.strip()
+        if line.startswith("endData"):
+            return waypoints
+        if not line:
+            continue
+        try:
+            x, y, speed = (float(field) for field in line.split(","))
+        except ValueError:
+            raise SystemExit(f"line {number}: expected 'x, y, speed', got {line!r}")
+        waypoints.append((x, y, speed))
+    raise SystemExit("no endData line; is this a path.jerryio export?")
+
+
+def read_segments(text):
+    """Control points of each segment of the first path in the editor blob, None if there is no blob."""
+    start = text.find(BLOB)
+    if start < 0:
+        return None
+    try:
+        data = json.loads(text[start + len(BLOB):])
+        segments = data["paths"][0]["segments"]
+        return [[(control["x"], control["y"]) for control in segment["controls"]] for segment in segments]
+    except (ValueError, KeyError, IndexError, TypeError) as error:
+        raise SystemExit(f"unreadable {BLOB} blob: {error!r}")
+
+
+def bezier(controls, t):
+    """Point t (0 - 1) along a line (2 controls) or cubic Bezier (4 controls)."""
+    if len(controls) == 2:
+        (x0, y0), (x1, y1) = controls
+        return x0 + (x1 - x0) * t, y0 + (y1 - y0) * t
+    if len(controls) != 4:
+        raise SystemExit(f"segments have 2 or 4 control points, got {len(controls)}")
+    u = 1 - t
+    weights = (u * u * u, 3 * u * u * t, 3 * u * t * t, t * t * t)
+    return (sum(w * x for w, (x, _) in zip(weights, controls)), sum(w * y for w, (_, y) in zip(weights, controls)))
+
+
+def resample(segments, spacing):
+    """Points every `spacing` inches of arc length along the segments, ending on the last control point."""
+    dense = [segments[0][0]]
+    for controls in segments:
+        dense += [bezier(controls, i / 200) for i in range(1, 201)]
+    points = [dense[0]]
+    travelled = 0.0  # arc length at dense[i]
+    target = spacing
+    for a, b in zip(dense, dense[1:]):
+        step = math.dist(a, b)
+        while step > 0 and travelled + step >= target:
+            t = (target - travelled) / step
+            points.append((a[0] + (b[0] - a[0]) * t, a[1] + (b[1] - a[1]) * t))
+            target += spacing
+        travelled += step
+    if math.dist(points[-1], dense[-1]) > spacing / 2:
+        points.append(dense[-1])
+    else:
+        points[-1] = dense[-1]
+    return points
+
+
+def curvature(a, b, c):
+    """Signed curvature of the circle through three points, 0 if they are collinear or repeated."""
+    ab, bc, ca = math.dist(a, b), math.dist(b, c), math.dist(c, a)
+    if ab * bc * ca == 0:
+        return 0.0
+    cross = (b[0] - a[0]) * (c[1] - b[1]) - (b[1] - a[1]) * (c[0] - b[0])
+    # a counterclockwise turn has a positive cross product; headings here are clockwise positive
+    return -2 * cross / (ab * bc * ca)
+
+
+def geometry(points):
+    distances = [0.0]
+    for a, b in zip(points, points[1:]):
+        distances.append(distances[-1] + math.dist(a, b))
+    curvatures = [curvature(a, b, c) for a, b, c in zip(points, points[1:], points[2:])]
+    curvatures = [curvatures[0]] + curvatures + [curvatures[-1]] if curvatures else [0.0, 0.0]
+    return distances, curvatures
+
+
+def plan(distances, curvatures):
+    """Time optimal velocities (in/s) from rest to rest.
+
+    Each waypoint is capped by the velocity limit, by the lateral acceleration
+    limit on its curvature and by the outer wheel reaching the velocity limit;
+    a forward and a backward pass then keep the acceleration between waypoints
+    within the limit, which is the fastest profile under these constraints.
+    Speeding up is further limited to what the motors have left after the
+    feedforward for the current velocity, less RESERVE, so a tracker that keeps
+    to the planned times (Tracker::RAMSETE) can actually keep up.
+    """
+    velocities = []
+    for k in curvatures:
+        k = abs(k)
+        v = MAX_VELOCITY
+        if k > 0:
+            v = min(v, math.sqrt(MAX_LATERAL_ACCELERATION / k), MAX_VELOCITY / (1 + k * TRACK_WIDTH / 2))
+        velocities.append(v)
+    velocities[0] = velocities[-1] = 0.0
+    # v^2 = v0^2 + 2ad, speeding up with what the motors have left over the feedforward for the velocity
+    for i in range(1, len(velocities)):
+        step = distances[i] - distances[i - 1]
+        available = (127 - RESERVE - KS - KV * velocities[i - 1]) / KA
+        acceleration = max(0.0, min(MAX_ACCELERATION, available))
+        velocities[i] = min(velocities[i], math.sqrt(velocities[i - 1] ** 2 + 2 * acceleration * step))
+    for i in range(len(velocities) - 2, -1, -1):
+        step = distances[i + 1] - distances[i]
+        velocities[i] = min(velocities[i], math.sqrt(velocities[i + 1] ** 2 + 2 * MAX_ACCELERATION * step))
+    return velocities
+
+
+def timestamps(distances, velocities):
+    times = [0.0]
+    for i in range(1, len(distances)):
+        average = (velocities[i - 1] + velocities[i]) / 2
+        times.append(times[-1] + ((distances[i] - distances[i - 1]) / average if average > 0 else 0.0))
+    return times
+
+
+def planned_waypoints(segments):
+    points = resample(segments, SPACING)
+    distances, curvatures = geometry(points)
+    velocities = plan(distances, curvatures)
+    times = timestamps(distances, velocities)
+    # Chassis::follow drives each waypoint's speed open loop, so store the power that holds the profile: the
+    # feedforward for the velocity and acceleration on the way to the next waypoint. It stops at the first zero
+    # speed, so only the last waypoint gets one.
+    speeds = []
+    for i in range(len(points) - 1):
+        acceleration = (velocities[i + 1] ** 2 - velocities[i] ** 2) / (2 * (distances[i + 1] - distances[i]))
+        power = KS + KV * max(velocities[i], velocities[i + 1]) + KA * acceleration
+        speeds.append(min(127.0, max(power, 1.0)))
+    speeds.append(0.0)
+    return [(x, y, speed) for (x, y), speed in zip(points, speeds)], times
+
+
+def pack(waypoints, times=None):
+    if len(waypoints) < 2 or len(waypoints) > 0xFFFF:
+        raise SystemExit(f"a path needs 2 to 65535 waypoints, got {len(waypoints)}")
+    distances, curvatures = geometry([waypoint[:2] for waypoint in waypoints])
+    if times is None:
+        # drawn speeds are motor units, taken as a fraction of the free speed
+        times = timestamps(distances, [speed / 127 * FREE_SPEED for _, _, speed in waypoints])
+    data = struct.pack("<4sHHf", MAGIC, VERSION, len(waypoints), distances[-1])
+    for waypoint, distance, k, time in zip(waypoints, distances, curvatures, times):
+        data += struct.pack("<ffffff", *waypoint, distance, k, time)
+    return data
+
+
+def main(argv):
+    editor_speeds = "--editor-speeds" in argv
+    argv = [arg for arg in argv if arg != "--editor-speeds"]
+    if len(argv) != 3:
+        raise SystemExit(__doc__.split("\n\n")[1])
+    with open(argv[1], encoding="utf-8") as source:
+        text = source.read()
+    segments = None if editor_speeds else read_segments(text)
+    if segments:
+        data = pack(*planned_waypoints(segments))
+    else:
+        data = pack(read_waypoints(text))
+    with open(argv[2], "wb") as output:
+        output.write(data)
+
+
+if __name__ == "__main__":
+    main(sys.argv)